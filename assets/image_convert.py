@@ -1,12 +1,9 @@
 #!/usr/bin/env python3
-""" print_image """
+""" image_convert """
 
 import argparse
 
 from PIL import Image
-from numpy import asarray
-
-from pathlib import Path
 
 # ================================================================================
 
@@ -17,37 +14,18 @@ def main():
 
     parser = argparse.ArgumentParser()
     parser.add_argument('name', help='image file name')
+    parser.add_argument('output', nargs='?', default='splash.png', help='splash file name')
     args = parser.parse_args()
 
     # ----------------------------------------------------------------------------
 
+    # The splash is stored as an 8 bit grey PNG and compiled in through
+    # showimage.qrc.
+
     image = Image.open(args.name)
 
     image_grey = image.convert('L')
-    numpydata = asarray(image_grey)
-
-    length = image.width * image.height
-    print(f"uchar splash[{length}] = ")
-    print("{")
-
-    codeWidth = 24
-
-    index = 0
-    for column in numpydata:
-        for pixel in column:
-            if ((index % codeWidth) == 0):
-                print("    ", end='')
-
-            print('0x{:02x},'.format(pixel), end='')
-
-            index += 1
-
-            if ((index % codeWidth) == 0):
-                print("")
-            else:
-                print(" ", end='')
-
-    print("};")
+    image_grey.save(args.output, optimize=True)
 
 # ================================================================================
 
@@ -26,6 +26,7 @@
 //-------------------------------------------------------------------------
 
 #include "enlighten.h"
+#include "greyscale.h"
 #include "ShowImage.h"
 #include "splash.h"
 
@@ -33,8 +34,8 @@
 #include <QDirIterator>
 #include <QFileDialog>
 #include <QFontMetrics>
-#include <QImageReader>
 #include <QKeyEvent>
+#include <QtConcurrent>
 #include <QThread>
 
 #include <algorithm>
@@ -48,23 +49,56 @@ ShowImage::ShowImage(QWidget* parent)
 :
     QMainWindow(parent),
     m_annotate{FONT_REGULAR},
+    m_annotationKey{},
+    m_annotationPixmap{},
     m_enlighten{0},
     m_files{},
+    m_firstPaintCallback{},
     m_frame{},
     m_greyscale{false},
     m_histogram{},
-    m_image{
-        splash,
-        ShowImage::DEFAULT_WIDTH,
-        ShowImage::DEFAULT_HEIGHT,
-        QImage::Format_Grayscale8
-    },
+    m_image{},
+    m_imageGreyscale{},
+    m_imageFrame{0},
+    m_imagePath{},
     m_imageProcessed{},
     m_isBlank{false},
     m_isSplash{true},
+    m_needsProcessing{false},
+    m_loader{},
+    m_pipeline{},
+    m_pipelineGeneration{0},
+    m_pipelineKey{},
+    m_pipelineStarted{0},
+    m_resizeTimer{},
+    m_scanDirectory{},
+    m_scanner{},
     m_offset{0, 0}
 {
-    QImageReader::setAllocationLimit(0);
+    connect(&m_loader,
+            &QFutureWatcher<LoadedImage>::finished,
+            this,
+            &ShowImage::imageLoaded);
+
+    connect(&m_scanner,
+            &QFutureWatcher<std::vector<QFileInfo>>::finished,
+            this,
+            &ShowImage::directoryScanned);
+
+    connect(&m_pipeline,
+            &QFutureWatcher<PipelineResult>::finished,
+            this,
+            &ShowImage::pipelineFinished);
+
+    m_resizeTimer.setSingleShot(true);
+    m_resizeTimer.setInterval(RESIZE_DELAY_MS);
+
+    connect(&m_resizeTimer,
+            &QTimer::timeout,
+            this,
+            &ShowImage::resized);
+
+    m_histogram.onRefined([this]() { update(); });
 }
 
 // ------------------------------------------------------------------------
@@ -119,10 +153,24 @@ ShowImage::mousePressEvent(QMouseEvent* event)
 // ------------------------------------------------------------------------
 
 void
-ShowImage::paintEvent(QPaintEvent*)
+ShowImage::paintEvent(QPaintEvent* event)
 {
+    if (m_needsProcessing)
+    {
+        m_needsProcessing = false;
+        processImage();
+    }
+
     QPainter painter(this);
-    paint(painter);
+    paint(painter, event->region());
+    painter.end();
+
+    if (m_firstPaintCallback)
+    {
+        const auto callback = std::move(m_firstPaintCallback);
+        m_firstPaintCallback = nullptr;
+        callback();
+    }
 }
 
 // ------------------------------------------------------------------------
@@ -135,8 +183,20 @@ ShowImage::resizeEvent(QResizeEvent *event)
         setExtents();
     }
 
+    // A drag generates a stream of resize events, so rather than process
+    // the image for each, paint() stretches the last one until the size
+    // settles.
+
     m_scale.screenResize(event->size());
-    processImage();
+    m_resizeTimer.start();
+}
+
+// ------------------------------------------------------------------------
+
+void
+ShowImage::resized()
+{
+    processImageAndUpdate();
 }
 
 // ------------------------------------------------------------------------
@@ -197,8 +257,47 @@ ShowImage::annotate(QPainter& painter)
         return;
     }
 
+    painter.drawPixmap(QPoint(0, 0), annotationPixmap());
+}
+
+// ------------------------------------------------------------------------
+
+ShowImage::AnnotationKey
+ShowImage::annotationKey() const
+{
+    return AnnotationKey
+    {
+        m_files.absolutePath(),
+        m_files.index(),
+        m_files.count(),
+        m_image.size(),
+        m_scale.percent(),
+        m_scale.originalSize(),
+        m_scale.smoothScale(),
+        m_greyscale,
+        m_scale.fitToScreen(),
+        m_enlighten,
+        m_frame.index(),
+        m_frame.max(),
+        m_histogram.statistics(),
+        m_annotate,
+        devicePixelRatioF()
+    };
+}
+
+// ------------------------------------------------------------------------
+
+const QPixmap&
+ShowImage::annotationPixmap()
+{
+    auto key = annotationKey();
+
+    if (not m_annotationPixmap.isNull() and (key == m_annotationKey))
+    {
+        return m_annotationPixmap;
+    }
+
     const auto text = annotation();
-    static constexpr int padding{4};
     const QFont font("Mulish", m_annotate);
 
     const QFontMetrics metrics(font);
@@ -207,14 +306,41 @@ ShowImage::annotate(QPainter& painter)
     {
         0,
         0,
-        bound.width() + 2 * padding,
-        bound.height() + 2 * padding
+        bound.width() + 2 * ANNOTATION_PADDING,
+        bound.height() + 2 * ANNOTATION_PADDING
     };
+
+    QPixmap pixmap{rect.size() * key.devicePixelRatio};
+    pixmap.setDevicePixelRatio(key.devicePixelRatio);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
     painter.fillRect(rect, QBrush(QColor(0, 0, 0, 128)));
 
     painter.setPen(QPen(Qt::green));
     painter.setFont(font);
-    painter.drawText(padding, m_annotate + padding, text);
+    painter.drawText(ANNOTATION_PADDING, m_annotate + ANNOTATION_PADDING, text);
+    painter.end();
+
+    m_annotationKey = std::move(key);
+    m_annotationPixmap = std::move(pixmap);
+
+    return m_annotationPixmap;
+}
+
+// ------------------------------------------------------------------------
+
+QRect
+ShowImage::annotationRect()
+{
+    if (not m_annotate or not haveImages())
+    {
+        return QRect{};
+    }
+
+    const auto& pixmap = annotationPixmap();
+
+    return QRect{QPoint(0, 0), pixmap.deviceIndependentSize().toSize()};
 }
 
 // ------------------------------------------------------------------------
@@ -249,22 +375,45 @@ ShowImage::annotation() const
                                                 QString::number(m_frame.max() + 1));
     }
 
+    if (const auto statistics = m_histogram.statistics())
+    {
+        text += QString(" [ min %1 max %2 mean %3 ]").arg(QString::number(statistics->minimum),
+                                                          QString::number(statistics->maximum),
+                                                          QString::number(statistics->mean, 'f', 1));
+    }
+
     return text;
 }
 
 // ------------------------------------------------------------------------
 
+void
+ShowImage::directoryScanned()
+{
+    // A directory opened since the scan started takes precedence.
+
+    if (m_files.directory() != m_scanDirectory)
+    {
+        return;
+    }
+
+    m_files.setFiles(m_scanner.result());
+    update();
+}
+
+// ------------------------------------------------------------------------
+
 void
 ShowImage::enlighten(bool decrease)
 {
-    bool repaint = false;
+    bool changed = false;
 
     if (decrease)
     {
         if (m_enlighten > ENLIGHTEN_MINIMUM)
         {
             --m_enlighten;
-            repaint = true;
+            changed = true;
         }
     }
     else
@@ -272,14 +421,14 @@ ShowImage::enlighten(bool decrease)
         if (m_enlighten < ENLIGHTEN_MAXIMUM)
         {
             ++m_enlighten;
-            repaint = true;
+            changed = true;
         }
     }
 
-    if (repaint)
+    if (changed)
     {
         m_histogram.invalidate();
-        processImageAndRepaint();
+        processImageAndUpdate();
     }
 }
 
@@ -374,7 +523,7 @@ ShowImage::handleImageViewingKeys(int key, bool isShift)
 
         case Qt::Key_C:
 
-            centerAndRepaint();
+            centerAndUpdate();
             break;
 
         case Qt::Key_D:
@@ -451,14 +600,62 @@ void
 ShowImage::histogram(QPainter& painter)
 {
     const auto& histogramImage = m_histogram.image();
-    if (histogramImage.isNull())
+
+    // Until the histogram is counted again, the one it has is that of
+    // the previous image.
+
+    if (histogramImage.isNull() or not m_histogram.isValid())
     {
         return;
     }
 
+    painter.drawImage(histogramRect().topLeft(), histogramImage);
+}
+
+// ------------------------------------------------------------------------
+
+QRect
+ShowImage::histogramRect() const
+{
+    const auto& histogramImage = m_histogram.image();
+    if (histogramImage.isNull() or not m_histogram.isValid())
+    {
+        return QRect{};
+    }
+
     const auto x = width() - histogramImage.width() - 2;
     const auto y = height() - histogramImage.height() - 2;
-    painter.drawImage(QPoint(x, y), histogramImage);
+
+    return QRect{QPoint(x, y), histogramImage.size()};
+}
+
+// ------------------------------------------------------------------------
+
+void
+ShowImage::imageLoaded()
+{
+    const auto loaded = m_loader.result();
+
+    if (loaded.isNewImage)
+    {
+        m_frame.set(loaded.frameCount - 1);
+    }
+
+    m_image = loaded.image;
+    m_imageGreyscale = QImage{};
+    m_imageFrame = loaded.frame;
+    m_imagePath = loaded.path;
+
+    if (loaded.isNewImage)
+    {
+        m_histogram.invalidate();
+    }
+    else
+    {
+        m_histogram.frameChanged();
+    }
+
+    processImageAndUpdate();
 }
 
 // ------------------------------------------------------------------------
@@ -497,45 +694,66 @@ ShowImage::openDirectory()
 // ------------------------------------------------------------------------
 
 void
-ShowImage::openFrame()
+ShowImage::open(const QString& path)
 {
-    QImageReader reader{m_files.path()};
+    const QFileInfo fileInfo(path);
 
-    for (auto i = 0 ; i < m_frame.index() ; ++i)
+    if (fileInfo.isDir())
     {
-        reader.read();
+        m_files.setDirectory(fileInfo.absoluteFilePath());
+        readDirectory();
     }
+    else if (fileInfo.isFile())
+    {
+        // Show the file straight away, and read the rest of its directory
+        // in the background (see directoryScanned()).
 
-    m_image = reader.read();
-    m_histogram.invalidate();
+        m_files.setFile(fileInfo);
+        splashScreenDisable();
+        openImage();
 
-    processImageAndRepaint();
+        m_scanDirectory = m_files.directory();
+        m_scanner.setFuture(QtConcurrent::run(Files::scanDirectory, m_scanDirectory));
+    }
 }
 
 // ------------------------------------------------------------------------
 
 void
-ShowImage::openImage()
+ShowImage::openFrame()
 {
-    QImageReader reader{m_files.path()};
+    m_loader.setFuture(QtConcurrent::run(loadImage, m_files.path(), m_frame.index(), false));
+}
 
-    m_frame.set(reader.imageCount() - 1);
-    m_image = reader.read();
+// ------------------------------------------------------------------------
 
+void
+ShowImage::openImage()
+{
+    // Decoding and conversion to the working format happen on a worker
+    // thread; imageLoaded() picks up the result.
+
+    m_frame.set(0);
     center();
     m_enlighten = 0;
-    m_histogram.invalidate();
 
-    processImageAndRepaint();
+    m_loader.setFuture(QtConcurrent::run(loadImage, m_files.path(), 0, true));
 }
 
 // ------------------------------------------------------------------------
 
 void
-ShowImage::paint(QPainter& painter)
+ShowImage::paint(
+    QPainter& painter,
+    const QRegion& exposed)
 {
     if (m_isSplash)
     {
+        if (m_image.isNull())
+        {
+            m_image = splashImage();
+        }
+
         painter.drawImage(placeImage(m_image), m_image);
         return;
     }
@@ -553,7 +771,36 @@ ShowImage::paint(QPainter& painter)
 
     if ((m_image.width() > 0) and (m_image.height() > 0))
     {
-        painter.drawImage(placeImage(m_imageProcessed), m_imageProcessed);
+        const auto displaySize = m_scale.displaySize();
+
+        if (m_resizeTimer.isActive() and (displaySize != m_scale.processedSize()))
+        {
+            painter.drawImage(QRect{placeImage(displaySize), displaySize}, m_imageProcessed);
+        }
+        else if (const auto zoom = m_scale.paintZoom() ; zoom > 1)
+        {
+            paintZoomed(painter, exposed, zoom);
+        }
+        else
+        {
+            // Only the exposed part of the image is drawn, which after a
+            // pan (see pan()) is just the strips scrolled into view and the
+            // overlays. Each is drawn on its own, as their bounding box
+            // would cover most of the window.
+
+            const auto origin = placeImage(m_imageProcessed);
+            const QRect image{origin, m_imageProcessed.size()};
+
+            for (const auto& rect : exposed)
+            {
+                const auto target = image.intersected(rect);
+
+                if (not target.isEmpty())
+                {
+                    painter.drawImage(target.topLeft(), m_imageProcessed, target.translated(-origin));
+                }
+            }
+        }
     }
 
     histogram(painter);
@@ -562,24 +809,108 @@ ShowImage::paint(QPainter& painter)
 
 // ------------------------------------------------------------------------
 
+void
+ShowImage::paintZoomed(
+    QPainter& painter,
+    const QRegion& exposed,
+    int zoom)
+{
+    // Draw only the source pixels that are exposed, replicated zoom times
+    // in each direction by QPainter's nearest pixel scaling.
+
+    const auto zoomedSize = m_imageProcessed.size() * zoom;
+    const auto origin = placeImage(zoomedSize);
+    const QRect zoomed{origin, zoomedSize};
+
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+
+    for (const auto& rect : exposed)
+    {
+        const auto visible = zoomed.intersected(rect);
+
+        if (visible.isEmpty())
+        {
+            continue;
+        }
+
+        const QRect source{QPoint{(visible.left() - origin.x()) / zoom,
+                                  (visible.top() - origin.y()) / zoom},
+                           QPoint{(visible.right() - origin.x()) / zoom,
+                                  (visible.bottom() - origin.y()) / zoom}};
+        const QRect target{origin + (source.topLeft() * zoom), source.size() * zoom};
+
+        painter.drawImage(target, m_imageProcessed, source);
+    }
+}
+
+// ------------------------------------------------------------------------
+
 void
 ShowImage::pan(int x, int y)
 {
     if (not m_scale.fitsWithinScreen())
     {
+        const QPoint before{m_offset.x(), m_offset.y()};
         const auto zoom = m_scale.zoomValue();
         m_offset.pan(x, y, zoom);
-        repaint();
+
+        if (m_needsProcessing or m_resizeTimer.isActive())
+        {
+            update();
+            return;
+        }
+
+        // Move what is already on the screen rather than paint it again,
+        // leaving only the strips scrolled into view to paint. The
+        // overlays should not have moved, so both where they are and
+        // where the scroll took them are painted again.
+
+        const auto delta = QPoint{m_offset.x(), m_offset.y()} - before;
+        scroll(delta.x(), delta.y());
+
+        for (const auto& overlay : {annotationRect(), histogramRect()})
+        {
+            update(overlay.united(overlay.translated(delta)));
+        }
     }
 }
 
 // ------------------------------------------------------------------------
 
+void
+ShowImage::pipelineFinished()
+{
+    if (m_pipelineStarted != m_pipelineGeneration)
+    {
+        return;
+    }
+
+    // A result at its display size needs no zoom at paint time, even
+    // where the preview was zoomed that way.
+
+    auto result = m_pipeline.result();
+    m_imageProcessed = std::move(result.image);
+
+    if (m_imageProcessed.size() == m_scale.displaySize())
+    {
+        m_scale.resampled(m_imageProcessed.size());
+    }
+
+    if (result.hasCounts)
+    {
+        m_histogram.process(result.counts, m_pipelineKey);
+    }
+
+    update();
+}
+
+// ------------------------------------------------------------------------
+
 QPoint
-ShowImage::placeImage(const QImage& image) const noexcept
+ShowImage::placeImage(const QSize& size) const noexcept
 {
-    const auto x = (width() / 2) - (image.width() / 2) + m_offset.x();
-    const auto y = (height() / 2) - (image.height() / 2) + m_offset.y();
+    const auto x = (width() / 2) - (size.width() / 2) + m_offset.x();
+    const auto y = (height() / 2) - (size.height() / 2) + m_offset.y();
 
     return QPoint(x, y);
 }
@@ -595,9 +926,24 @@ ShowImage::processImage()
     }
 
     processImageGreyscale();
+
+    if (processImageProgressive())
+    {
+        return;
+    }
+
     processImageEnlighten();
     processImageHistogram();
     processImageResize();
+    processImageDisplay();
+}
+
+// ------------------------------------------------------------------------
+
+void
+ShowImage::processImageDisplay()
+{
+    m_imageProcessed = displayImage(std::move(m_imageProcessed));
 }
 
 // ------------------------------------------------------------------------
@@ -608,7 +954,20 @@ ShowImage::processImageEnlighten()
     if (m_enlighten > 0)
     {
         const auto enlighten = m_enlighten / static_cast<double>(ENLIGHTEN_MAXIMUM);
-        m_imageProcessed = ::enlighten(m_imageProcessed, enlighten);
+
+        // Count the histogram while enlightening, rather than reading
+        // the enlightened image again in processImageHistogram().
+
+        if (m_histogram.needsProcessing())
+        {
+            HistogramCounts counts;
+            m_imageProcessed = ::enlighten(m_imageProcessed, enlighten, &counts);
+            m_histogram.process(counts, statisticsKey());
+        }
+        else
+        {
+            m_imageProcessed = ::enlighten(m_imageProcessed, enlighten);
+        }
     }
 }
 
@@ -617,9 +976,21 @@ ShowImage::processImageEnlighten()
 void
 ShowImage::processImageGreyscale()
 {
-    m_imageProcessed = (m_greyscale)
-                     ? m_image.convertToFormat(QImage::Format_Grayscale8)
-                     : m_image;
+    if (not m_greyscale)
+    {
+        m_imageProcessed = m_image;
+        return;
+    }
+
+    // Kept until the image changes, so that zooming or toggling the
+    // greyscale view does not convert it again.
+
+    if (m_imageGreyscale.isNull())
+    {
+        m_imageGreyscale = greyscale(m_image);
+    }
+
+    m_imageProcessed = m_imageGreyscale;
 }
 
 // ------------------------------------------------------------------------
@@ -627,7 +998,107 @@ ShowImage::processImageGreyscale()
 void
 ShowImage::processImageHistogram()
 {
-    m_histogram.process(m_imageProcessed);
+    // The key costs a stat of the file, so it is only made when the
+    // histogram is to be counted (or found in the cache).
+
+    const auto key = (m_histogram.needsProcessing()) ? statisticsKey() : QString{};
+    m_histogram.process(m_imageProcessed, key);
+}
+
+// ------------------------------------------------------------------------
+//
+// Large images are first shown roughly: scaled with the fast
+// transformation and then enlightened at that size, which takes a fraction
+// of the time of the real thing, or as they are where that scaling leaves
+// them at their own size. The full pipeline then runs in the background
+// and pipelineFinished() swaps its result in. Returns false if
+// the image should be processed in the usual way.
+//
+// ------------------------------------------------------------------------
+
+bool
+ShowImage::processImageProgressive()
+{
+    const auto pixels = static_cast<qint64>(m_imageProcessed.width()) * m_imageProcessed.height();
+
+    if (pixels < PROGRESSIVE_PIXELS)
+    {
+        return false;
+    }
+
+    const auto input = m_imageProcessed;
+    auto preview = m_scale.scale(input, Qt::FastTransformation);
+
+    if (preview.size() == input.size())
+    {
+        // At actual size, or zoomed at paint time, a preview would cost as
+        // much to enlighten as the image itself. The image is shown as it
+        // is until the background pipeline has enlightened it (counting
+        // the histogram as it goes), and smooth zoomed it if need be.
+
+        const auto isSmoothZoomed = (m_scale.paintZoom() > 1) and m_scale.smoothScale();
+
+        if (m_enlighten == 0)
+        {
+            processImageHistogram();
+        }
+
+        if ((m_enlighten > 0) or isSmoothZoomed)
+        {
+            const auto size = (isSmoothZoomed) ? m_scale.displaySize() : input.size();
+            processImagePipeline(input, m_enlighten / static_cast<double>(ENLIGHTEN_MAXIMUM), size);
+        }
+
+        processImageDisplay();
+
+        return true;
+    }
+
+    if ((m_enlighten == 0) and not m_scale.smoothScale())
+    {
+        // The preview is the final image.
+
+        processImageHistogram();
+        m_imageProcessed = std::move(preview);
+        processImageDisplay();
+
+        return true;
+    }
+
+    const auto enlighten = m_enlighten / static_cast<double>(ENLIGHTEN_MAXIMUM);
+
+    if (m_enlighten > 0)
+    {
+        preview = ::enlighten(preview, enlighten);
+    }
+    else
+    {
+        processImageHistogram();
+    }
+
+    m_imageProcessed = displayImage(std::move(preview));
+    processImagePipeline(input, enlighten, m_scale.displaySize());
+
+    return true;
+}
+
+// ------------------------------------------------------------------------
+
+void
+ShowImage::processImagePipeline(
+    const QImage& input,
+    double enlighten,
+    const QSize& size)
+{
+    PipelineOptions options;
+    options.enlighten = enlighten;
+    options.countHistogram = m_histogram.needsProcessing();
+    options.size = size;
+    options.mode = m_scale.transformationMode();
+
+    m_pipelineKey = (options.countHistogram) ? statisticsKey() : QString{};
+    m_pipelineStarted = m_pipelineGeneration;
+    m_pipeline.setFuture(QtConcurrent::run(runPipeline, input, options));
 }
 
 // ------------------------------------------------------------------------
@@ -674,10 +1145,9 @@ ShowImage::splashScreenEnable()
     if (not m_isSplash)
     {
         m_isSplash = true;
-        m_image = QImage(splash,
-                         ShowImage::DEFAULT_WIDTH,
-                         ShowImage::DEFAULT_HEIGHT,
-                         QImage::Format_Grayscale8);
+        m_image = splashImage();
+        m_imageGreyscale = QImage{};
+        m_imagePath.clear();
 
         center();
 
@@ -687,8 +1157,21 @@ ShowImage::splashScreenEnable()
         }
 
         setExtents();
-        repaint();
+        update();
+    }
+}
+
+// ------------------------------------------------------------------------
+
+QString
+ShowImage::statisticsKey() const
+{
+    if (m_imagePath.isEmpty())
+    {
+        return QString{};
     }
+
+    return ::statisticsKey(m_imagePath, m_imageFrame, m_greyscale, m_enlighten);
 }
 
 // ------------------------------------------------------------------------
@@ -713,7 +1196,7 @@ ShowImage::toggleAnnotation()
         m_annotate = FONT_OFF;
         break;
     }
-    repaint();
+    update();
 }
 
 // ------------------------------------------------------------------------
@@ -722,7 +1205,7 @@ void
 ShowImage::toggleBlankScreen()
 {
     m_isBlank = not m_isBlank;
-    repaint();
+    update();
 }
 
 // ------------------------------------------------------------------------
@@ -731,7 +1214,7 @@ void
 ShowImage::toggleFitToScreen()
 {
     m_scale.toggleFitToScreen();
-    processImageAndRepaint();
+    processImageAndUpdate();
 }
 
 // ------------------------------------------------------------------------
@@ -756,7 +1239,7 @@ ShowImage::toggleGreyScale()
 {
     m_greyscale = !m_greyscale;
     m_histogram.invalidate();
-    processImageAndRepaint();
+    processImageAndUpdate();
 }
 
 // ------------------------------------------------------------------------
@@ -765,7 +1248,7 @@ void
 ShowImage::toggleHistogram()
 {
     m_histogram.toggle();
-    processImageAndRepaint();
+    processImageAndUpdate();
 }
 
 // ------------------------------------------------------------------------
@@ -777,7 +1260,7 @@ ShowImage::toggleSmoothScale()
 
     if (not m_scale.originalSize())
     {
-        processImageAndRepaint();
+        processImageAndUpdate();
     }
 }
 
@@ -789,7 +1272,7 @@ ShowImage::zoomIn()
     if (m_scale.zoomIn())
     {
         m_offset.zoomed(m_scale.zoomValue());
-        processImageAndRepaint();
+        processImageAndUpdate();
     }
 }
 
@@ -801,6 +1284,6 @@ ShowImage::zoomOut()
     if (m_scale.zoomOut())
     {
         m_offset.zoomed(m_scale.zoomValue());
-        processImageAndRepaint();
+        processImageAndUpdate();
     }
 }
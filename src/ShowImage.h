@@ -27,14 +27,22 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QMainWindow>
 #include <QPainter>
+#include <QPixmap>
+#include <QRegion>
+#include <QTimer>
 
 #include "files.h"
 #include "frame.h"
 #include "histogram.h"
+#include "loader.h"
+#include "pipeline.h"
 #include "scale.h"
 
+#include <functional>
+#include <optional>
 #include <vector>
 
 // ------------------------------------------------------------------------
@@ -65,8 +73,13 @@ public:
     void resizeEvent(QResizeEvent *event) override;
     void wheelEvent(QWheelEvent* event) override;
 
+    void open(const QString& path);
     void setExtents();
 
+    // Called once, after the window has first been painted.
+
+    void onFirstPaint(std::function<void()> callback) { m_firstPaintCallback = std::move(callback); }
+
 private:
 
     // --------------------------------------------------------------------
@@ -118,6 +131,34 @@ private:
         int m_zoomedY{};
     };
 
+    // --------------------------------------------------------------------
+    //
+    // Everything the annotation shows. The annotation is only laid out
+    // again when its key changes.
+    //
+    // --------------------------------------------------------------------
+
+    struct AnnotationKey
+    {
+        QString path{};
+        std::size_t index{};
+        std::size_t count{};
+        QSize imageSize{};
+        int percent{};
+        bool originalSize{};
+        bool smoothScale{};
+        bool greyscale{};
+        bool fitToScreen{};
+        int enlighten{};
+        int frame{};
+        int frameMax{};
+        std::optional<ImageStatistics> statistics{};
+        int fontSize{};
+        qreal devicePixelRatio{};
+
+        bool operator==(const AnnotationKey&) const = default;
+    };
+
     // --------------------------------------------------------------------
 
     [[nodiscard]] const char* colourLabel() const noexcept { return (m_greyscale) ? " [ grey ]" : " [ colour ]"; }
@@ -136,45 +177,66 @@ private:
 
     // --------------------------------------------------------------------
 
-    void centerAndRepaint()
+    void centerAndUpdate()
     {
         center();
-        repaint();
+        update();
     }
 
     // --------------------------------------------------------------------
 
-    void processImageAndRepaint()
+    // Processing is left to the next paintEvent(), so that any number of
+    // changes made before it is delivered are processed, and painted, once.
+
+    void processImageAndUpdate()
     {
-        processImage();
-        repaint();
+        // Any result still being computed in the background is stale from
+        // now on, not from the paint that processes the image.
+
+        ++m_pipelineGeneration;
+        m_needsProcessing = true;
+        update();
     }
 
     // --------------------------------------------------------------------
 
     void annotate(QPainter& painter);
     [[nodiscard]] QString annotation() const;
+    [[nodiscard]] AnnotationKey annotationKey() const;
+    [[nodiscard]] const QPixmap& annotationPixmap();
+    [[nodiscard]] QRect annotationRect();
+    void directoryScanned();
     void enlighten(bool decrease);
     void frameNext();
     void framePrevious();
     void handleGeneralKeys(int key, bool isShift);
     void handleImageViewingKeys(int key, bool isShift);
     void histogram(QPainter& painter);
+    [[nodiscard]] QRect histogramRect() const;
+    void imageLoaded();
     void imageNext(bool step = false);
     void imagePrevious(bool step = false);
     void openDirectory();
     void openFrame();
     void openImage();
-    void paint(QPainter& painter);
+    void paint(QPainter& painter, const QRegion& exposed);
+    void paintZoomed(QPainter& painter, const QRegion& exposed, int zoom);
+    void pipelineFinished();
     void pan(int x, int y);
-    [[nodiscard]] QPoint placeImage(const QImage& image) const noexcept;
+    [[nodiscard]] QPoint placeImage(const QImage& image) const noexcept { return placeImage(image.size()); }
+    [[nodiscard]] QPoint placeImage(const QSize& size) const noexcept;
     void processImage();
+    void processImageDisplay();
     void processImageEnlighten();
     void processImageGreyscale();
     void processImageHistogram();
+    void processImagePipeline(const QImage& input, double enlighten, const QSize& size);
+    [[nodiscard]] bool processImageProgressive();
     void processImageResize();
     void readDirectory();
+    void resized();
     void splashScreenDisable();
+    [[nodiscard]] QString statisticsKey() const;
     void splashScreenEnable();
     void toggleAnnotation();
     void toggleBlankScreen();
@@ -205,6 +267,16 @@ private:
         ENLIGHTEN_MAXIMUM = 10
     };
 
+    // Resizing is only processed once the window has kept its size this long.
+
+    static const int RESIZE_DELAY_MS{100};
+
+    // Images with at least this many pixels are processed progressively.
+
+    static const int PROGRESSIVE_PIXELS{1 << 22};
+
+    static const int ANNOTATION_PADDING{4};
+
     enum PanStep
     {
         PAN_STEP_SMALL = 10,
@@ -212,15 +284,30 @@ private:
     };
 
     AnnotationFont m_annotate;
+    AnnotationKey m_annotationKey;
+    QPixmap m_annotationPixmap;
     int m_enlighten;
     Files m_files;
+    std::function<void()> m_firstPaintCallback;
     Frame m_frame;
     bool m_greyscale;
     Histogram m_histogram;
     QImage m_image;
+    QImage m_imageGreyscale;
+    int m_imageFrame;
+    QString m_imagePath;
     QImage m_imageProcessed;
     bool m_isBlank;
     bool m_isSplash;
+    bool m_needsProcessing;
+    QFutureWatcher<LoadedImage> m_loader;
+    QFutureWatcher<PipelineResult> m_pipeline;
+    int m_pipelineGeneration;
+    QString m_pipelineKey;
+    int m_pipelineStarted;
+    QTimer m_resizeTimer;
     Scale m_scale;
+    QString m_scanDirectory;
+    QFutureWatcher<std::vector<QFileInfo>> m_scanner;
     Offset m_offset;
 };
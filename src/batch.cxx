@@ -0,0 +1,333 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2024 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include "batch.h"
+#include "files.h"
+#include "loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <iostream>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+
+struct FileResult
+{
+    qint64 pixels{0};
+    QString error{};
+};
+
+// ------------------------------------------------------------------------
+
+QSize
+batchSize(
+    const QSize& size,
+    int width)
+{
+    // An invalid size leaves the image at its own size.
+
+    if ((width <= 0) or (size.width() <= width))
+    {
+        return QSize{};
+    }
+
+    const auto height = std::lround(size.height() * static_cast<double>(width) / size.width());
+
+    return QSize(width, std::max(1, static_cast<int>(height)));
+}
+
+// ------------------------------------------------------------------------
+
+QString
+batchOutputPath(
+    const QDir& input,
+    const QDir& output,
+    const QFileInfo& file,
+    const QList<QByteArray>& writable)
+{
+    // Keep the name and relative directory, but write formats Qt cannot
+    // (GIF) as PNG. The original suffix is kept too, as in foo.gif.png,
+    // so that the result cannot overwrite that of a sibling foo.png.
+
+    auto path = output.filePath(input.relativeFilePath(file.absoluteFilePath()));
+
+    if (not writable.contains(file.suffix().toLower().toUtf8()))
+    {
+        path += ".png";
+    }
+
+    return path;
+}
+
+// ------------------------------------------------------------------------
+
+FileResult
+batchFile(
+    const BatchOptions& options,
+    const QFileInfo& file,
+    const QString& outputPath)
+{
+    FileResult result;
+
+    // One decoded image and the buffers derived from it are held per
+    // file for as long as it takes to write it.
+
+    const auto loaded = loadImage(file.filePath(), 0, true);
+
+    if (loaded.image.isNull())
+    {
+        result.error = "cannot read image";
+        return result;
+    }
+
+    auto pipeline = options.pipeline;
+    pipeline.countHistogram = false;
+    pipeline.size = batchSize(loaded.image.size(), options.width);
+    pipeline.mode = Qt::SmoothTransformation;
+
+    auto image = runPipeline(loaded.image, pipeline).image;
+
+    if (pipeline.greyscale)
+    {
+        image.convertTo(QImage::Format_Grayscale8);
+    }
+
+    if (not QDir().mkpath(QFileInfo(outputPath).absolutePath()))
+    {
+        result.error = "cannot create directory";
+        return result;
+    }
+
+    QImageWriter writer(outputPath);
+
+    if (not writer.write(image))
+    {
+        result.error = writer.errorString();
+        return result;
+    }
+
+    result.pixels = static_cast<qint64>(loaded.image.width()) * loaded.image.height();
+
+    return result;
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+int
+runBatch(
+    const BatchOptions& options,
+    std::ostream& report)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // As in the viewer, images are not refused for their size.
+
+    QImageReader::setAllocationLimit(0);
+
+    const auto files = Files::scanDirectory(options.input);
+    const QDir input(options.input);
+    const QDir output(options.output);
+    const auto writable = QImageWriter::supportedImageFormats();
+
+    // Each job decodes, processes and writes a whole file, so the number
+    // of jobs bounds the images in memory. The kernels within a job still
+    // slice rows across the global thread pool.
+
+    QThreadPool pool;
+    pool.setMaxThreadCount((options.jobs > 0) ? options.jobs : QThread::idealThreadCount());
+
+    std::atomic<int> failed{0};
+    std::atomic<qint64> pixels{0};
+    QMutex reportMutex;
+    std::set<QString> outputPaths;
+
+    for (const auto& file : files)
+    {
+        const auto outputPath = batchOutputPath(input, output, file, writable);
+
+        // Two jobs writing the same file would lose one of the results.
+
+        if (not outputPaths.insert(outputPath).second)
+        {
+            ++failed;
+
+            QMutexLocker locker(&reportMutex);
+            report << file.filePath().toStdString()
+                   << ": output "
+                   << outputPath.toStdString()
+                   << " is already written by another file\n";
+
+            continue;
+        }
+
+        pool.start([&, file, outputPath]()
+        {
+            const auto result = batchFile(options, file, outputPath);
+
+            if (result.error.isEmpty())
+            {
+                pixels += result.pixels;
+            }
+            else
+            {
+                ++failed;
+
+                QMutexLocker locker(&reportMutex);
+                report << file.filePath().toStdString()
+                       << ": "
+                       << result.error.toStdString()
+                       << "\n";
+            }
+        });
+    }
+
+    pool.waitForDone();
+
+    const auto seconds = std::max(timer.nsecsElapsed() / 1.0e9, 1.0e-9);
+    const auto failures = failed.load();
+    const auto processed = static_cast<int>(files.size()) - failures;
+
+    report << processed
+           << " files ("
+           << failures
+           << " failed) in "
+           << seconds
+           << " s, "
+           << (processed / seconds)
+           << " files/s, "
+           << (pixels.load() / seconds / 1.0e6)
+           << " Mpixel/s with "
+           << pool.maxThreadCount()
+           << " jobs\n";
+
+    return failures;
+}
+
+// ------------------------------------------------------------------------
+
+bool
+isBatch(
+    int argc,
+    char* argv[])
+{
+    for (auto i = 1 ; i < argc ; ++i)
+    {
+        if ((std::strcmp(argv[i], "--batch") == 0) or (std::strncmp(argv[i], "--batch=", 8) == 0))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ------------------------------------------------------------------------
+
+int
+batchMain(
+    int argc,
+    char* argv[])
+{
+    // Nothing is drawn in batch mode, so no GUI application (or display)
+    // is needed.
+
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Image viewer, batch mode");
+    parser.addHelpOption();
+
+    const QCommandLineOption batch("batch",
+                                   "Write the processed images below <output>.",
+                                   "output");
+    const QCommandLineOption enlighten("enlighten",
+                                       "Enlighten strength, 0 to 100 (default 50).",
+                                       "percent",
+                                       "50");
+    const QCommandLineOption greyscale("greyscale",
+                                       "Convert the images to greyscale.");
+    const QCommandLineOption width("width",
+                                   "Reduce wider images to this width.",
+                                   "pixels",
+                                   "0");
+    const QCommandLineOption jobs("jobs",
+                                  "Files processed at once (default, one per core).",
+                                  "count",
+                                  "0");
+
+    parser.addOption(batch);
+    parser.addOption(enlighten);
+    parser.addOption(greyscale);
+    parser.addOption(width);
+    parser.addOption(jobs);
+    parser.addPositionalArgument("input", "Directory of images to process.");
+    parser.process(application);
+
+    const auto arguments = parser.positionalArguments();
+
+    if (arguments.size() != 1)
+    {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    BatchOptions options;
+    options.input = arguments.first();
+    options.output = parser.value(batch);
+    options.pipeline.greyscale = parser.isSet(greyscale);
+    options.pipeline.enlighten = std::clamp(parser.value(enlighten).toInt(), 0, 100) / 100.0;
+    options.width = std::max(0, parser.value(width).toInt());
+    options.jobs = std::max(0, parser.value(jobs).toInt());
+
+    return (runBatch(options, std::cout) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
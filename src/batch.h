@@ -0,0 +1,71 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2024 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <QString>
+
+#include "pipeline.h"
+
+#include <ostream>
+
+// ------------------------------------------------------------------------
+
+struct BatchOptions
+{
+    QString input{};
+    QString output{};
+    PipelineOptions pipeline{};
+    int width{0};
+    int jobs{0};
+};
+
+// ------------------------------------------------------------------------
+//
+// Run the image pipeline over every image below options.input, without a
+// window, writing each result to the same relative path below
+// options.output. Files are processed options.jobs at a time (all cores
+// if 0), which also bounds how many decoded images are held at once.
+// Images wider than options.width, if it is not 0, are reduced to that
+// width. Throughput is reported to report. Returns the number of files
+// that failed.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] int runBatch(const BatchOptions& options, std::ostream& report);
+
+// ------------------------------------------------------------------------
+//
+// Batch mode is chosen by --batch on the command line, before main()
+// creates a QApplication. batchMain() parses the batch arguments, runs the
+// batch and returns the process exit code.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] bool isBatch(int argc, char* argv[]);
+[[nodiscard]] int batchMain(int argc, char* argv[]);
+
@@ -0,0 +1,447 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2024 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+// ------------------------------------------------------------------------
+//
+// Benchmarks for the image kernels, over the source formats the loader
+// sees, image sizes from a thumbnail to 100 megapixels and thread counts
+// from one to every core. Built when SHOWIMAGE_BENCHMARK is on.
+//
+// The usual Google Benchmark flags apply, so for example
+//
+//     showimage_bench --benchmark_filter='enlighten/RGB32/.*'
+//     showimage_bench --benchmark_out=bench.json --benchmark_out_format=json
+//
+// select benchmarks and write JSON for regression tracking. Each run also
+// reports its throughput in pixels per second (items_per_second).
+//
+// ------------------------------------------------------------------------
+
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <QThreadPool>
+
+#include <benchmark/benchmark.h>
+
+#include "enlighten.h"
+#include "greyscale.h"
+#include "histogram.h"
+#include "loader.h"
+#include "pipeline.h"
+#include "scale.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+
+struct Format
+{
+    const char* name;
+    QImage::Format format;
+};
+
+static constexpr std::array Formats
+{
+    Format{"ARGB32", QImage::Format_ARGB32},
+    Format{"RGB32", QImage::Format_RGB32},
+    Format{"Grayscale8", QImage::Format_Grayscale8},
+    Format{"RGB888", QImage::Format_RGB888},
+    Format{"Indexed8", QImage::Format_Indexed8}
+};
+
+// ------------------------------------------------------------------------
+
+struct Size
+{
+    const char* name;
+    int width;
+    int height;
+};
+
+static constexpr std::array Sizes
+{
+    Size{"thumbnail", 160, 120},
+    Size{"2MP", 1920, 1080},
+    Size{"12MP", 4000, 3000},
+    Size{"100MP", 11548, 8660}
+};
+
+static constexpr QSize ScreenSize{1920, 1080};
+
+// ------------------------------------------------------------------------
+//
+// Each kernel is timed on prepare(image), if prepare is set, so that for
+// example blur() sees the grey image enlighten() would give it. Kernels
+// with flat set are also timed on a flat image, of a few values like a sky
+// or a scan, which is the worst case for counting.
+//
+// ------------------------------------------------------------------------
+
+using KernelFunction = void (*)(const QImage&);
+using PrepareFunction = QImage (*)(const QImage&);
+
+struct Kernel
+{
+    const char* name;
+    PrepareFunction prepare;
+    KernelFunction run;
+    bool flat;
+};
+
+void
+paint(const QImage& image)
+{
+    static QImage target;
+
+    if (target.size() != image.size())
+    {
+        target = QImage{image.size(), QImage::Format_RGB32};
+    }
+
+    QPainter painter(&target);
+    painter.drawImage(0, 0, image);
+}
+
+const std::array Kernels
+{
+    Kernel
+    {
+        "workingImage",
+        nullptr,
+        [](const QImage& image) { benchmark::DoNotOptimize(workingImage(image)); },
+        false
+    },
+    Kernel
+    {
+        "maximum",
+        nullptr,
+        [](const QImage& image) { benchmark::DoNotOptimize(maximum(image)); },
+        false
+    },
+    Kernel
+    {
+        "blur",
+        maximum,
+        [](const QImage& image) { benchmark::DoNotOptimize(blur(image, 12)); },
+        false
+    },
+    Kernel
+    {
+        "enlighten",
+        nullptr,
+        [](const QImage& image) { benchmark::DoNotOptimize(enlighten(image, 0.5)); },
+        false
+    },
+    Kernel
+    {
+        "enlightenCounted",
+        nullptr,
+        [](const QImage& image)
+        {
+            HistogramCounts counts;
+            benchmark::DoNotOptimize(enlighten(image, 0.5, &counts));
+        },
+        false
+    },
+    Kernel
+    {
+        "histogramRGB",
+        nullptr,
+        [](const QImage& image) { benchmark::DoNotOptimize(histogramRGB(image)); },
+        true
+    },
+    Kernel
+    {
+        "histogramIntensity",
+        nullptr,
+        [](const QImage& image) { benchmark::DoNotOptimize(histogramIntensity(image)); },
+        true
+    },
+    Kernel
+    {
+        "greyscale",
+        nullptr,
+        [](const QImage& image) { benchmark::DoNotOptimize(greyscale(image)); },
+        false
+    },
+    Kernel
+    {
+        "scale",
+        nullptr,
+        [](const QImage& image)
+        {
+            Scale scale;
+            scale.screenResize(ScreenSize);
+            benchmark::DoNotOptimize(scale.scale(image, Qt::SmoothTransformation));
+        },
+        false
+    },
+    Kernel
+    {
+        "paint",
+        [](const QImage& image) { return displayImage(image); },
+        paint,
+        false
+    }
+};
+
+// ------------------------------------------------------------------------
+
+enum class Pattern
+{
+    Noisy,
+    Flat
+};
+
+// ------------------------------------------------------------------------
+
+QRgb
+testPixel(
+    Pattern pattern,
+    int i,
+    int j,
+    int width,
+    int height)
+{
+    if (pattern == Pattern::Flat)
+    {
+        // Four bands of one colour each, so that neighbouring pixels
+        // nearly always fall in the same bin.
+
+        const auto band = j * 4 / height;
+
+        return qRgb(96 + band, 144 + band, 208 + band);
+    }
+
+    // Smooth gradients with some noise, so that the image has a spread of
+    // values like a photograph, and partial transparency at the edges.
+
+    const auto noise = static_cast<int>(((i * 7919u) ^ (j * 104729u)) % 32u);
+    const auto red = (i * 223 / width) + noise;
+    const auto green = (j * 223 / height) + noise;
+    const auto blue = ((i + j) * 223 / (width + height)) + noise;
+    const auto alpha = ((i < 16) or (j < 16)) ? 128 : 255;
+
+    return qRgba(red, green, blue, alpha);
+}
+
+// ------------------------------------------------------------------------
+
+QImage
+testImage(
+    Pattern pattern,
+    QImage::Format format,
+    int width,
+    int height)
+{
+    QImage image{width, height, format};
+
+    if (format == QImage::Format_Indexed8)
+    {
+        QList<QRgb> colours;
+
+        for (auto k = 0 ; k < 256 ; ++k)
+        {
+            colours.push_back(qRgb(k, 255 - k, (k * 7) & 0xFF));
+        }
+
+        image.setColorTable(colours);
+    }
+
+    for (auto j = 0 ; j < height ; ++j)
+    {
+        auto* line = image.scanLine(j);
+
+        for (auto i = 0 ; i < width ; ++i)
+        {
+            const auto rgb = testPixel(pattern, i, j, width, height);
+
+            switch (format)
+            {
+                case QImage::Format_ARGB32:
+                case QImage::Format_RGB32:
+
+                    reinterpret_cast<QRgb*>(line)[i] = (format == QImage::Format_RGB32)
+                                                     ? (rgb | 0xFF000000)
+                                                     : rgb;
+                    break;
+
+                case QImage::Format_RGB888:
+
+                    line[3 * i] = qRed(rgb);
+                    line[3 * i + 1] = qGreen(rgb);
+                    line[3 * i + 2] = qBlue(rgb);
+                    break;
+
+                default:
+
+                    line[i] = qGray(rgb);
+                    break;
+            }
+        }
+    }
+
+    return image;
+}
+
+// ------------------------------------------------------------------------
+
+const QImage&
+cachedTestImage(
+    Pattern pattern,
+    QImage::Format format,
+    int width,
+    int height)
+{
+    // Benchmarks are registered so that consecutive runs share an image,
+    // and only one is kept, as the largest are hundreds of megabytes.
+
+    static QImage image;
+    static Pattern imagePattern{Pattern::Noisy};
+
+    if ((imagePattern != pattern) or
+        (image.format() != format) or
+        (image.width() != width) or
+        (image.height() != height))
+    {
+        image = QImage{};
+        image = testImage(pattern, format, width, height);
+        imagePattern = pattern;
+    }
+
+    return image;
+}
+
+// ------------------------------------------------------------------------
+
+void
+runKernel(
+    benchmark::State& state,
+    const Kernel& kernel,
+    Pattern pattern,
+    const Format& format,
+    const Size& size)
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(static_cast<int>(state.range(0)));
+
+    const auto& source = cachedTestImage(pattern, format.format, size.width, size.height);
+    const auto input = (kernel.prepare) ? kernel.prepare(source) : source;
+
+    for (auto _ : state)
+    {
+        kernel.run(input);
+    }
+
+    state.SetItemsProcessed(state.iterations() * size.width * size.height);
+}
+
+// ------------------------------------------------------------------------
+
+std::vector<int>
+threadCounts()
+{
+    const auto ideal = QThread::idealThreadCount();
+    std::vector<int> counts;
+
+    for (auto threads = 1 ; threads < ideal ; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+
+    counts.push_back(ideal);
+
+    return counts;
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+int
+main(
+    int argc,
+    char* argv[])
+{
+    benchmark::Initialize(&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+
+    const auto threads = threadCounts();
+
+    for (const auto& format : Formats)
+    {
+        for (const auto& size : Sizes)
+        {
+            for (const auto pattern : {Pattern::Noisy, Pattern::Flat})
+            {
+                for (const auto& kernel : Kernels)
+                {
+                    if ((pattern == Pattern::Flat) and not kernel.flat)
+                    {
+                        continue;
+                    }
+
+                    auto name = std::string(kernel.name) + "/" + format.name + "/" + size.name;
+
+                    if (pattern == Pattern::Flat)
+                    {
+                        name += "/flat";
+                    }
+
+                    auto* registered = benchmark::RegisterBenchmark(name, runKernel, kernel, pattern, format, size);
+
+                    for (const auto count : threads)
+                    {
+                        registered->Arg(count);
+                    }
+
+                    registered->ArgName("threads")->UseRealTime()->Unit(benchmark::kMillisecond);
+                }
+            }
+        }
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
@@ -0,0 +1,61 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+
+// ------------------------------------------------------------------------
+
+struct RGBCount
+{
+    int r{0};
+    int g{0};
+    int b{0};
+
+    bool operator==(const RGBCount&) const = default;
+};
+
+using RGBCountArray = std::array<RGBCount, 256>;
+using IntensityCountArray = std::array<int, 256>;
+
+// ------------------------------------------------------------------------
+//
+// Counts for both histogram styles, as accumulated by kernels that can
+// count their output while they write it (see enlighten()).
+//
+// ------------------------------------------------------------------------
+
+struct HistogramCounts
+{
+    RGBCountArray rgb{};
+    IntensityCountArray intensity{};
+
+    bool operator==(const HistogramCounts&) const = default;
+};
+
+void add(HistogramCounts& target, const HistogramCounts& source);
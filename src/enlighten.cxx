@@ -25,14 +25,14 @@
 //
 //-------------------------------------------------------------------------
 
-#include <QtConcurrent>
-#include <QFuture>
-#include <QFutureWatcher>
-#include <QThread>
-
 #include "enlighten.h"
+#include "pixel.h"
 #include "slice.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
 // ========================================================================
 
 namespace
@@ -51,12 +51,13 @@ flerp(
 
 // ------------------------------------------------------------------------
 
+template<typename Sample>
 void
 rowBlur(
     int jStart,
     int jEnd,
     const QImage& input,
-    QImage& rb,
+    const ScanLines& rb,
     int radius)
 {
     const auto width = input.width();
@@ -64,8 +65,8 @@ rowBlur(
 
     for (auto j = jStart ; j < jEnd ; ++j)
     {
-        const auto* row = input.constScanLine(j);
-        auto* outputRow = rb.scanLine(j);
+        const auto* row = reinterpret_cast<const Sample*>(input.constScanLine(j));
+        auto* outputRow = reinterpret_cast<Sample*>(rb[j]);
 
         int sum{0};
 
@@ -86,196 +87,101 @@ rowBlur(
 
 // ------------------------------------------------------------------------
 
+template<typename Sample>
 void
 columnBlur(
     int iStart,
     int iEnd,
     const QImage& rb,
-    QImage& output,
+    const ScanLines& output,
     int radius)
 {
     const auto height = rb.height();
     const auto diameter = 2 * radius + 1;
 
+    const auto sample = [&rb, height](int j, int i)
+    {
+        const auto* row = rb.constScanLine(std::clamp(j, 0, height - 1));
+        return reinterpret_cast<const Sample*>(row)[i];
+    };
+
     for (auto i = iStart ; i < iEnd ; ++i)
     {
         int sum{0};
 
         for (auto k = -radius - 1 ; k < radius ; ++k)
         {
-            sum += *(rb.constScanLine(std::clamp(k, 0, height - 1)) + i);
+            sum += sample(k, i);
         }
 
         for (auto j = 0 ; j < height ; ++j)
         {
-            sum += *(rb.constScanLine(std::clamp(j + radius, 0, height - 1)) + i);
-            sum -= *(rb.constScanLine(std::clamp(j - radius - 1, 0, height - 1)) + i);
+            sum += sample(j + radius, i);
+            sum -= sample(j - radius - 1, i);
 
-            *(output.scanLine(j) + i) = sum / diameter;
+            reinterpret_cast<Sample*>(output[j])[i] = sum / diameter;
         }
     }
 }
 
 // ------------------------------------------------------------------------
 
-QImage
-blur(
-    const QImage& input,
-    int radius)
+template<typename Accessor>
+void
+maximumRowWide(
+    int j,
+    int width,
+    const Accessor& accessor,
+    const ScanLines& output)
 {
-    const auto width = input.width();
-    const auto height = input.height();
-
-    QImage rb{width, height, QImage::Format_Grayscale8};
-    QImage output{width, height, QImage::Format_Grayscale8};
-
-    const auto rowThreads = concurrentRowSlice(input);
+    const auto pixel = accessor.wideRow(j);
+    auto* outputRow = reinterpret_cast<quint16*>(output[j]);
 
-    if (rowThreads)
+    for (auto i = 0 ; i < width ; ++i)
     {
-        const auto rowsPerCore = height / *rowThreads;
-        QFutureSynchronizer<void> rowSynchronizer;
-        auto rowRunner = [=, &input, &rb](int jStart, int jEnd)
-        {
-            rowBlur(jStart, jEnd, input, rb, radius);
-        };
+        const auto rgba = pixel(i);
+        const auto max = std::max({rgba.red(), rgba.green(), rgba.blue()});
 
-        for (auto thread = 0 ; thread < *rowThreads ; ++thread)
+        if constexpr (Accessor::isPremultiplied)
         {
-            const auto jStart = thread * rowsPerCore;
-            const auto jEnd = (thread == *rowThreads - 1) ? height : (jStart + rowsPerCore);
-
-            rowSynchronizer.addFuture(QtConcurrent::run(rowRunner, jStart, jEnd));
+            *(outputRow++) = max;
         }
-
-        rowSynchronizer.waitForFinished();
-    }
-    else
-    {
-        rowBlur(0, height, input, rb, radius);
-    }
-
-    const auto columnThreads = concurrentColumnSlice(input);
-
-    if (columnThreads)
-    {
-        const auto columnPerCore = width / *columnThreads;
-        QFutureSynchronizer<void> columnSynchronizer;
-        auto columnRunner = [=, &rb, &output](int iStart, int iEnd)
+        else
         {
-            columnBlur(iStart, iEnd, rb, output, radius);
-        };
-
-        for (auto thread = 0 ; thread < *columnThreads ; ++thread)
-        {
-            const auto iStart = thread * columnPerCore;
-            const auto iEnd = (thread == *columnThreads - 1) ? width : (iStart + columnPerCore);
-
-            columnSynchronizer.addFuture(QtConcurrent::run(columnRunner, iStart, iEnd));
+            *(outputRow++) = (static_cast<std::uint32_t>(max) * rgba.alpha()) / 0xFFFF;
         }
-
-        columnSynchronizer.waitForFinished();
-    }
-    else
-    {
-        columnBlur(0, width, rb, output, radius);
     }
-
-    return output;
 }
 
-// -------------------------------------------------------------------------
+// ------------------------------------------------------------------------
 
+template<typename Accessor>
 void
 maximumRow(
     int j,
-    const QImage& input,
-    QImage& output)
-{
-    const auto width = input.width();
-    auto* outputRow = output.scanLine(j);
-
-    for (auto i = 0 ; i < width ; ++i)
-    {
-        const auto c = input.pixelColor(i, j);
-        *(outputRow++) = std::max({c.red(), c.green(), c.blue()});
-    }
-}
-
-// -------------------------------------------------------------------------
-
-void
-maximumRowARGB32(
-    int row,
-    const QImage& input,
-    QImage& output)
+    int width,
+    const Accessor& accessor,
+    const ScanLines& output)
 {
-    const auto width = input.width();
-    auto* outputRow = output.scanLine(row);
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(row));
+    const auto pixel = accessor.row(j);
+    auto* outputRow = output[j];
 
     for (auto i = 0 ; i < width ; ++i)
     {
-        auto rgb = *(pixel++);
-        *(outputRow++) = std::max({qRed(rgb), qGreen(rgb), qBlue(rgb)}) * qAlpha(rgb) / 255;
-    }
-}
-
-// -------------------------------------------------------------------------
-
-void
-maximumRowRGB32(
-    int row,
-    const QImage& input,
-    QImage& output)
-{
-    const auto width = input.width();
-    auto* outputRow = output.scanLine(row);
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(row));
+        const auto rgb = pixel(i);
 
-    for (auto i = 0 ; i < width ; ++i)
-    {
-        auto rgb = *(pixel++);
-        *(outputRow++) = std::max({qRed(rgb), qGreen(rgb), qBlue(rgb)});
-    }
-}
-
-// -------------------------------------------------------------------------
-
-void
-maximumRowGrey8(
-    int row,
-    const QImage& input,
-    QImage& output)
-{
-    const auto width = input.width();
-    const auto* pixel = input.constScanLine(row);
-    std::copy(pixel, pixel + width, output.scanLine(row));
-}
-
-// -------------------------------------------------------------------------
-
-auto
-maximumRowFunction(
-    const QImage& input)
-{
-    switch (input.format())
-    {
-        case QImage::Format_ARGB32:
-
-            return maximumRowARGB32;
-
-        case QImage::Format_RGB32:
-
-            return maximumRowRGB32;
-
-        case QImage::Format_Grayscale8:
-
-            return maximumRowGrey8;
-
-        default:
-
-            return maximumRow;
+        if constexpr (Accessor::isGrey)
+        {
+            *(outputRow++) = qBlue(rgb);
+        }
+        else if constexpr (Accessor::isPremultiplied)
+        {
+            *(outputRow++) = std::max({qRed(rgb), qGreen(rgb), qBlue(rgb)});
+        }
+        else
+        {
+            *(outputRow++) = std::max({qRed(rgb), qGreen(rgb), qBlue(rgb)}) * qAlpha(rgb) / 255;
+        }
     }
 }
 
@@ -286,70 +192,47 @@ maximumRowRange(
     int jStart,
     int jEnd,
     const QImage& input,
-    QImage& output)
+    const ScanLines& output)
 {
-    auto rowFunction = maximumRowFunction(input);
-
-    for (auto j = jStart ; j < jEnd ; ++j)
-    {
-        rowFunction(j, input, output);
-    }
-}
-
-// ------------------------------------------------------------------------
-
-QImage
-maximum(const QImage& input)
-{
-    const auto height = input.height();
     const auto width = input.width();
 
-    QImage output{width, height, QImage::Format_Grayscale8};
-    const auto threads = concurrentRowSlice(input);
-
-    if (threads)
+    withPixelAccessor(input, [=, &output](const auto& accessor)
     {
-        const auto rowsPerCore = height / *threads;
-        QFutureSynchronizer<void> synchronizer;
-        auto runner = [=, &input, &output](int jStart, int jEnd)
+        for (auto j = jStart ; j < jEnd ; ++j)
         {
-            maximumRowRange(jStart, jEnd, input, output);
-        };
-
-        for (auto thread = 0 ; thread < *threads ; ++thread)
-        {
-            const auto jStart = thread * rowsPerCore;
-            const auto jEnd = (thread == *threads - 1) ? height : (jStart + rowsPerCore);
-
-            synchronizer.addFuture(QtConcurrent::run(runner, jStart, jEnd));
+            if constexpr (std::decay_t<decltype(accessor)>::isWide)
+            {
+                maximumRowWide(j, width, accessor, output);
+            }
+            else
+            {
+                maximumRow(j, width, accessor, output);
+            }
         }
-    }
-    else
-    {
-        maximumRowRange(0, height, input, output);
-    }
-
-    return output;
+    });
 }
 
 // ------------------------------------------------------------------------
 
+template<bool Count, typename Accessor>
 void
 enlighterRow(
     int j,
+    int width,
     double minI,
     double maxI,
     const QImage& mb,
-    const QImage& input,
-    QImage& output)
+    const Accessor& accessor,
+    const ScanLines& output,
+    HistogramCounts* counts)
 {
-    const auto width = input.width();
+    const auto pixel = accessor.row(j);
     const auto* mbRow = mb.constScanLine(j);
-    auto* outputRow = reinterpret_cast<QRgb*>(output.scanLine(j));
+    auto* outputRow = reinterpret_cast<QRgb*>(output[j]);
 
     for (auto i = 0 ; i < width ; ++i)
     {
-        auto c = input.pixel(i, j);
+        auto c = pixel(i);
         const auto max = *(mbRow++);
         const auto illumination = std::clamp(max / 255.0, minI, maxI);
 
@@ -358,217 +241,290 @@ enlighterRow(
             const auto p = illumination / maxI;
             const auto scale = (0.4 + (p * 0.6)) / p;
 
-            const auto red = static_cast<int>(std::clamp(qRed(c) * scale, 0.0, 255.0));
-            const auto green = static_cast<int>(std::clamp(qGreen(c) * scale, 0.0, 255.0));
-            const auto blue = static_cast<int>(std::clamp(qBlue(c) * scale, 0.0, 255.0));
+            // The scale applies to the straight colour, which is then
+            // written opaque.
 
-            c = qRgb(red, green, blue);
-        }
+            if constexpr (Accessor::isPremultiplied and not Accessor::isGrey)
+            {
+                c = qUnpremultiply(c);
+            }
 
-        *(outputRow++) = c;
-    }
-}
-
-// -------------------------------------------------------------------------
-
-void
-enlighterRowARGB32(
-    int j,
-    double minI,
-    double maxI,
-    const QImage& mb,
-    const QImage& input,
-    QImage& output)
-{
-    const auto width = input.width();
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(j));
-    const auto* mbRow = mb.constScanLine(j);
-    auto* outputRow = reinterpret_cast<QRgb*>(output.scanLine(j));
+            if constexpr (Accessor::isGrey)
+            {
+                const auto grey = static_cast<int>(std::clamp(qBlue(c) * scale, 0.0, 255.0));
 
-    for (auto i = 0 ; i < width ; ++i)
-    {
-        auto c = *(pixel++);
-        const auto max = *(mbRow++);
-        const auto illumination = std::clamp(max / 255.0, minI, maxI);
+                c = qRgb(grey, grey, grey);
+            }
+            else
+            {
+                const auto red = static_cast<int>(std::clamp(qRed(c) * scale, 0.0, 255.0));
+                const auto green = static_cast<int>(std::clamp(qGreen(c) * scale, 0.0, 255.0));
+                const auto blue = static_cast<int>(std::clamp(qBlue(c) * scale, 0.0, 255.0));
 
-        if (illumination < maxI)
+                c = qRgb(red, green, blue);
+            }
+        }
+        else if constexpr (not Accessor::isPremultiplied)
         {
-            const auto p = illumination / maxI;
-            const auto scale = (0.4 + (p * 0.6)) / p;
-
-            const auto red = static_cast<int>(std::clamp(qRed(c) * scale, 0.0, 255.0));
-            const auto green = static_cast<int>(std::clamp(qGreen(c) * scale, 0.0, 255.0));
-            const auto blue = static_cast<int>(std::clamp(qBlue(c) * scale, 0.0, 255.0));
-
-            c = qRgb(red, green, blue);
+            c = qPremultiply(c);
         }
 
         *(outputRow++) = c;
+
+        if constexpr (Count)
+        {
+            ++(counts->rgb[qRed(c)].r);
+            ++(counts->rgb[qGreen(c)].g);
+            ++(counts->rgb[qBlue(c)].b);
+            ++(counts->intensity[qGray(c)]);
+        }
     }
 }
 
-// -------------------------------------------------------------------------
+// ------------------------------------------------------------------------
 
+template<bool Count, typename Accessor>
 void
-enlighterRowRGB32(
+enlighterRowWide(
     int j,
+    int width,
     double minI,
     double maxI,
     const QImage& mb,
-    const QImage& input,
-    QImage& output)
+    const Accessor& accessor,
+    const ScanLines& output,
+    HistogramCounts* counts)
 {
-    const auto width = input.width();
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(j));
-    const auto* mbRow = mb.constScanLine(j);
-    auto* outputRow = reinterpret_cast<QRgb*>(output.scanLine(j));
+    const auto pixel = accessor.wideRow(j);
+    const auto* mbRow = reinterpret_cast<const quint16*>(mb.constScanLine(j));
+    auto* outputRow = reinterpret_cast<QRgba64*>(output[j]);
+
+    const auto scaled = [](quint16 value, double scale)
+    {
+        return static_cast<quint16>(std::clamp(value * scale, 0.0, 65535.0));
+    };
 
     for (auto i = 0 ; i < width ; ++i)
     {
-        auto c = *(pixel++);
+        auto c = pixel(i);
         const auto max = *(mbRow++);
-        const auto illumination = std::clamp(max / 255.0, minI, maxI);
+        const auto illumination = std::clamp(max / 65535.0, minI, maxI);
 
         if (illumination < maxI)
         {
             const auto p = illumination / maxI;
             const auto scale = (0.4 + (p * 0.6)) / p;
 
-            const auto red = static_cast<int>(std::clamp(qRed(c) * scale, 0.0, 255.0));
-            const auto green = static_cast<int>(std::clamp(qGreen(c) * scale, 0.0, 255.0));
-            const auto blue = static_cast<int>(std::clamp(qBlue(c) * scale, 0.0, 255.0));
-
-            c = qRgb(red, green, blue);
+            if constexpr (Accessor::isPremultiplied and not Accessor::isGrey)
+            {
+                c = c.unpremultiplied();
+            }
+
+            if constexpr (Accessor::isGrey)
+            {
+                const auto grey = scaled(c.red(), scale);
+
+                c = qRgba64(grey, grey, grey, 0xFFFF);
+            }
+            else
+            {
+                c = qRgba64(scaled(c.red(), scale),
+                            scaled(c.green(), scale),
+                            scaled(c.blue(), scale),
+                            0xFFFF);
+            }
+        }
+        else if constexpr (not Accessor::isPremultiplied)
+        {
+            c = c.premultiplied();
         }
 
         *(outputRow++) = c;
+
+        if constexpr (Count)
+        {
+            // Binned as the histogram bins 16 bit images.
+
+            ++(counts->rgb[c.red() >> 8].r);
+            ++(counts->rgb[c.green() >> 8].g);
+            ++(counts->rgb[c.blue() >> 8].b);
+            ++(counts->intensity[qGray(c.red(), c.green(), c.blue()) >> 8]);
+        }
     }
 }
 
-// -------------------------------------------------------------------------
+// ------------------------------------------------------------------------
 
 void
-enlighterRowGrey8(
-    int j,
+enlightenRowRange(
+    int jStart,
+    int jEnd,
     double minI,
     double maxI,
     const QImage& mb,
     const QImage& input,
-    QImage& output)
+    const ScanLines& output,
+    HistogramCounts* counts)
 {
     const auto width = input.width();
-    const auto* pixel = input.constScanLine(j);
-    const auto* mbRow = mb.constScanLine(j);
-    auto* outputRow = reinterpret_cast<QRgb*>(output.scanLine(j));
 
-    for (auto i = 0 ; i < width ; ++i)
+    withPixelAccessor(input, [=, &mb, &output](const auto& accessor)
     {
-        auto grey = *(pixel++);
-        const auto max = *(mbRow++);
-        const auto illumination = std::clamp(max / 255.0, minI, maxI);
-
-        if (illumination < maxI)
+        for (auto j = jStart ; j < jEnd ; ++j)
         {
-            const auto p = illumination / maxI;
-            const auto scale = (0.4 + (p * 0.6)) / p;
-
-            grey = static_cast<int>(std::clamp(grey * scale, 0.0, 255.0));
+            if constexpr (std::decay_t<decltype(accessor)>::isWide)
+            {
+                if (counts)
+                {
+                    enlighterRowWide<true>(j, width, minI, maxI, mb, accessor, output, counts);
+                }
+                else
+                {
+                    enlighterRowWide<false>(j, width, minI, maxI, mb, accessor, output, counts);
+                }
+            }
+            else if (counts)
+            {
+                enlighterRow<true>(j, width, minI, maxI, mb, accessor, output, counts);
+            }
+            else
+            {
+                enlighterRow<false>(j, width, minI, maxI, mb, accessor, output, counts);
+            }
         }
+    });
+}
 
-        *(outputRow++) = qRgb(grey, grey, grey);;
-    }
+// ------------------------------------------------------------------------
 
 }
 
-// -------------------------------------------------------------------------
+// ========================================================================
 
-auto
-enlightenRowFunction(
-    const QImage& input)
+QImage
+blur(
+    const QImage& input,
+    int radius)
 {
-    switch (input.format())
-    {
-        case QImage::Format_ARGB32:
-
-            return enlighterRowARGB32;
-
-        case QImage::Format_RGB32:
-
-            return enlighterRowRGB32;
+    const auto width = input.width();
+    const auto height = input.height();
+    const auto isWide = (input.format() == QImage::Format_Grayscale16);
 
-        case QImage::Format_Grayscale8:
+    QImage rb{width, height, input.format()};
+    QImage output{width, height, input.format()};
 
-            return enlighterRowGrey8;
+    const ScanLines rbLines{rb};
+    concurrentRows("blur rows", input, [&input, &rbLines, radius, isWide](int jStart, int jEnd)
+    {
+        if (isWide)
+        {
+            rowBlur<quint16>(jStart, jEnd, input, rbLines, radius);
+        }
+        else
+        {
+            rowBlur<uchar>(jStart, jEnd, input, rbLines, radius);
+        }
+    });
 
-        default:
+    const ScanLines outputLines{output};
+    concurrentColumns("blur columns", input, [&rb, &outputLines, radius, isWide](int iStart, int iEnd)
+    {
+        if (isWide)
+        {
+            columnBlur<quint16>(iStart, iEnd, rb, outputLines, radius);
+        }
+        else
+        {
+            columnBlur<uchar>(iStart, iEnd, rb, outputLines, radius);
+        }
+    });
 
-            return enlighterRow;
-    }
+    return output;
 }
 
 // ------------------------------------------------------------------------
 
-void
-enlightenRowRange(
-    int jStart,
-    int jEnd,
-    double minI,
-    double maxI,
-    const QImage& mb,
-    const QImage& input,
-    QImage& output)
+QImage
+maximum(const QImage& input)
 {
-    auto rowFunction = enlightenRowFunction(input);
+    const auto height = input.height();
+    const auto width = input.width();
 
-    for (auto j = jStart ; j < jEnd ; ++j)
-    {
-        rowFunction(j, minI, maxI, mb, input, output);
-    }
-}
+    // 16 bit images keep a 16 bit maximum, so that the illumination, and
+    // with it the enlightened image, does not band.
 
-// ------------------------------------------------------------------------
+    const auto format = (isWideImage(input))
+                      ? QImage::Format_Grayscale16
+                      : QImage::Format_Grayscale8;
+    QImage output{width, height, format};
 
+    const ScanLines outputLines{output};
+    concurrentRows("maximum", input, [&input, &outputLines](int jStart, int jEnd)
+    {
+        maximumRowRange(jStart, jEnd, input, outputLines);
+    });
+
+    return output;
 }
 
-// ========================================================================
+// ------------------------------------------------------------------------
 
 QImage
 enlighten(
     const QImage& input,
-    double strength)
+    double strength,
+    HistogramCounts* counts)
 {
     const auto mb = blur(maximum(input), 12);
     const auto height = input.height();
     const auto width = input.width();
 
-    QImage output{width, height, QImage::Format_ARGB32};
+    // Every pixel the kernels write is either opaque or premultiplied, so
+    // the output can be drawn without conversion. 16 bit images stay 16 bit
+    // until they are displayed.
+
+    auto format = (input.hasAlphaChannel())
+                ? QImage::Format_ARGB32_Premultiplied
+                : QImage::Format_RGB32;
+
+    if (isWideImage(input))
+    {
+        format = (input.hasAlphaChannel())
+               ? QImage::Format_RGBA64_Premultiplied
+               : QImage::Format_RGBX64;
+    }
+
+    QImage output{width, height, format};
 
     const auto strength2 = strength * strength;
     const auto minI = 1.0 / flerp(1.0, 10.0, strength2);
     const auto maxI = 1.0 / flerp(1.0, 1.111, strength2);
 
-    const auto cores = QThread::idealThreadCount();
-    const auto rowsPerCore = height / cores;
+    const ScanLines outputLines{output};
 
-    if ((cores == 1) or (rowsPerCore < 100))
+    if (counts)
     {
-        enlightenRowRange(0, height, minI, maxI, mb, input, output);
+        *counts = concurrentRowsReduce<HistogramCounts>(
+            "enlighten counted",
+            input,
+            [=, &mb, &input, &outputLines](int jStart, int jEnd)
+            {
+                HistogramCounts sliceCounts;
+                enlightenRowRange(jStart, jEnd, minI, maxI, mb, input, outputLines, &sliceCounts);
+
+                return sliceCounts;
+            },
+            [](HistogramCounts& target, const HistogramCounts& source)
+            {
+                add(target, source);
+            });
     }
     else
     {
-        QFutureSynchronizer<void> synchronizer;
-        auto runner = [=, &mb, &input, &output](int jStart, int jEnd)
-        {
-            enlightenRowRange(jStart, jEnd, minI, maxI, mb, input, output);
-        };
-
-        for (auto core = 0 ; core < cores ; ++core)
+        concurrentRows("enlighten", input, [=, &mb, &input, &outputLines](int jStart, int jEnd)
         {
-            const auto jStart = core * rowsPerCore;
-            const auto jEnd = (core == cores - 1) ? height : (jStart + rowsPerCore);
-
-            synchronizer.addFuture(QtConcurrent::run(runner, jStart, jEnd));
-        }
+            enlightenRowRange(jStart, jEnd, minI, maxI, mb, input, outputLines, nullptr);
+        });
     }
 
     return output;
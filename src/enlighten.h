@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include "histogram.h"
+
 #include <QImage>
 
 // ------------------------------------------------------------------------
@@ -37,5 +39,24 @@
 //
 // ------------------------------------------------------------------------
 
-QImage enlighten(const QImage& input, double strength);
+// When counts is not null, the histogram of the output is accumulated
+// while it is written, saving the histogram a separate pass.
+
+QImage
+enlighten(
+    const QImage& input,
+    double strength,
+    HistogramCounts* counts = nullptr);
+
+// ------------------------------------------------------------------------
+//
+// The stages of enlighten(), also used on their own by the benchmarks.
+// maximum() is the largest colour channel of each pixel, weighted by its
+// alpha, as Format_Grayscale8 (Format_Grayscale16 for 16 bit images).
+// blur() is a box blur of such a grey image, radius pixels each way.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] QImage maximum(const QImage& input);
+[[nodiscard]] QImage blur(const QImage& input, int radius);
 
@@ -29,6 +29,9 @@
 
 #include "files.h"
 
+#include <algorithm>
+#include <utility>
+
 //-------------------------------------------------------------------------
 
 void
@@ -85,11 +88,22 @@ Files::previous(bool step) noexcept
 bool
 Files::readDirectory()
 {
-    m_files.clear();
+    m_files = scanDirectory(m_directory);
+    m_current = (m_files.size() > 0) ? 0 : INVALID_INDEX;
+
+    return haveImages();
+}
+
+//-------------------------------------------------------------------------
+
+std::vector<QFileInfo>
+Files::scanDirectory(const QString& directory)
+{
+    std::vector<QFileInfo> files;
 
-    if (m_directory.length() > 0)
+    if (directory.length() > 0)
     {
-        QDirIterator iter(m_directory,
+        QDirIterator iter(directory,
                           {"*.bmp", "*.gif", "*.jpg", "*.jpeg", "*.png"},
                           QDir::Files,
                           QDirIterator::Subdirectories);
@@ -99,24 +113,63 @@ Files::readDirectory()
 
             if (fileInfo.isFile())
             {
-                m_files.push_back(fileInfo);
+                files.push_back(fileInfo);
             }
         }
     }
 
-    if (m_files.size() > 0)
+    std::ranges::sort(
+        files,
+        [](const auto& lhs, const auto& rhs)
+        {
+            return lhs.absoluteFilePath() < rhs.absoluteFilePath();
+        });
+
+    return files;
+}
+
+//-------------------------------------------------------------------------
+
+void
+Files::setFile(const QFileInfo& file)
+{
+    m_directory = file.absolutePath();
+    m_files = {file};
+    m_current = 0;
+}
+
+//-------------------------------------------------------------------------
+
+void
+Files::setFiles(std::vector<QFileInfo> files)
+{
+    if (not haveImages())
     {
-        std::ranges::sort(
-            m_files,
-            [](const auto& lhs, const auto& rhs)
-            {
-                return lhs.absoluteFilePath() < rhs.absoluteFilePath();
-            });
+        m_files = std::move(files);
+        m_current = (m_files.size() > 0) ? 0 : INVALID_INDEX;
+        return;
+    }
+
+    // The current file is kept even if the scan did not find it, for
+    // example because its name has an extension the scan does not match.
+
+    const auto current = m_files[m_current];
+    const auto path = current.absoluteFilePath();
 
-        m_current = 0;
-        return true;
+    auto found = std::lower_bound(
+        files.begin(),
+        files.end(),
+        path,
+        [](const auto& fileInfo, const auto& value)
+        {
+            return fileInfo.absoluteFilePath() < value;
+        });
+
+    if ((found == files.end()) or (found->absoluteFilePath() != path))
+    {
+        found = files.insert(found, current);
     }
 
-    m_current = INVALID_INDEX;
-    return false;
+    m_current = static_cast<std::size_t>(found - files.begin());
+    m_files = std::move(files);
 }
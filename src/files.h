@@ -52,6 +52,14 @@ public:
     void previous(bool step = false) noexcept;
     [[nodiscard]] bool readDirectory();
 
+    // A single file can be shown while the rest of its directory is read
+    // by scanDirectory() on a worker thread. setFiles() then takes the
+    // sorted list and keeps the current file selected.
+
+    void setFile(const QFileInfo& file);
+    void setFiles(std::vector<QFileInfo> files);
+    [[nodiscard]] static std::vector<QFileInfo> scanDirectory(const QString& directory);
+
 private:
 
     static const std::size_t INVALID_INDEX{std::numeric_limits<std::size_t>::max()};
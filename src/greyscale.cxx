@@ -0,0 +1,187 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include "greyscale.h"
+#include "pixel.h"
+#include "slice.h"
+
+#include <cstdint>
+#include <type_traits>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+//
+// The common case, written as plain integer arithmetic over a whole row
+// so that the compiler vectorises it. (11r + 16g + 5b) / 32 is qGray().
+//
+// ------------------------------------------------------------------------
+
+void
+greyscaleRowRgb32(
+    const QRgb* line,
+    int width,
+    uchar* outputRow)
+{
+    for (auto i = 0 ; i < width ; ++i)
+    {
+        const auto rgb = line[i];
+        const auto red = (rgb >> 16) & 0xFF;
+        const auto green = (rgb >> 8) & 0xFF;
+        const auto blue = rgb & 0xFF;
+
+        outputRow[i] = static_cast<uchar>(((red * 11) + (green * 16) + (blue * 5)) >> 5);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+template<typename Accessor>
+void
+greyscaleRow(
+    int j,
+    int width,
+    const Accessor& accessor,
+    const ScanLines& output)
+{
+    if constexpr (std::is_same_v<Accessor, PixelRGB32>)
+    {
+        greyscaleRowRgb32(accessor.line(j), width, output[j]);
+    }
+    else
+    {
+        const auto pixel = accessor.row(j);
+        auto* outputRow = output[j];
+
+        for (auto i = 0 ; i < width ; ++i)
+        {
+            const auto rgb = pixel(i);
+
+            if constexpr (Accessor::isGrey)
+            {
+                *(outputRow++) = qBlue(rgb);
+            }
+            else if constexpr (Accessor::isPremultiplied)
+            {
+                *(outputRow++) = qGray(rgb);
+            }
+            else
+            {
+                *(outputRow++) = (qGray(rgb) * qAlpha(rgb)) / 255;
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+template<typename Accessor>
+void
+greyscaleRowWide(
+    int j,
+    int width,
+    const Accessor& accessor,
+    const ScanLines& output)
+{
+    const auto pixel = accessor.wideRow(j);
+    auto* outputRow = reinterpret_cast<quint16*>(output[j]);
+
+    for (auto i = 0 ; i < width ; ++i)
+    {
+        const auto rgba = pixel(i);
+        const auto grey = static_cast<std::uint32_t>(qGray(rgba.red(), rgba.green(), rgba.blue()));
+
+        if constexpr (Accessor::isPremultiplied)
+        {
+            *(outputRow++) = grey;
+        }
+        else
+        {
+            *(outputRow++) = (grey * rgba.alpha()) / 0xFFFF;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void
+greyscaleRowRange(
+    int jStart,
+    int jEnd,
+    const QImage& input,
+    const ScanLines& output)
+{
+    const auto width = input.width();
+
+    withPixelAccessor(input, [=, &output](const auto& accessor)
+    {
+        for (auto j = jStart ; j < jEnd ; ++j)
+        {
+            if constexpr (std::decay_t<decltype(accessor)>::isWide)
+            {
+                greyscaleRowWide(j, width, accessor, output);
+            }
+            else
+            {
+                greyscaleRow(j, width, accessor, output);
+            }
+        }
+    });
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+QImage
+greyscale(
+    const QImage& input)
+{
+    if ((input.format() == QImage::Format_Grayscale8) or
+        (input.format() == QImage::Format_Grayscale16))
+    {
+        return input;
+    }
+
+    const auto format = (isWideImage(input))
+                      ? QImage::Format_Grayscale16
+                      : QImage::Format_Grayscale8;
+    QImage output{input.width(), input.height(), format};
+
+    const ScanLines outputLines{output};
+    concurrentRows("greyscale", input, [&input, &outputLines](int jStart, int jEnd)
+    {
+        greyscaleRowRange(jStart, jEnd, input, outputLines);
+    });
+
+    return output;
+}
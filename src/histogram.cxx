@@ -26,55 +26,444 @@
 //-------------------------------------------------------------------------
 
 #include <QtConcurrent>
-#include <QFuture>
-#include <QFutureWatcher>
-#include <QThread>
 
 #include "histogram.h"
+#include "pixel.h"
 #include "slice.h"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <ranges>
+#include <type_traits>
 
 // ========================================================================
 
+namespace
+{
+
+// ------------------------------------------------------------------------
+
+HistogramCounts
+countImage(
+    const QImage& image,
+    bool intensity,
+    int step)
+{
+    HistogramCounts counts;
+
+    if (intensity)
+    {
+        counts.intensity = ::histogramIntensityCounts(image, step);
+    }
+    else
+    {
+        counts.rgb = ::histogramRGBCounts(image, step);
+    }
+
+    return counts;
+}
+
+// ------------------------------------------------------------------------
+
+QImage
+renderCounts(
+    const HistogramCounts& counts,
+    bool intensity)
+{
+    return (intensity)
+         ? ::histogramIntensity(counts.intensity)
+         : ::histogramRGB(counts.rgb);
+}
+
+// ------------------------------------------------------------------------
+
+QString
+styleKey(
+    const QString& key,
+    bool intensity)
+{
+    if (key.isEmpty())
+    {
+        return key;
+    }
+
+    return key + ((intensity) ? "|intensity" : "|rgb");
+}
+
+// ------------------------------------------------------------------------
+
 void
-Histogram::process(const QImage& image)
+subtract(
+    HistogramCounts& target,
+    const HistogramCounts& source)
 {
-    if (m_isValid)
+    for (auto i = 0 ; i < static_cast<int>(target.rgb.size()) ; ++i)
     {
-        return;
+        target.rgb[i].r -= source.rgb[i].r;
+        target.rgb[i].g -= source.rgb[i].g;
+        target.rgb[i].b -= source.rgb[i].b;
+        target.intensity[i] -= source.intensity[i];
     }
+}
 
-    m_isValid = true;
+// ------------------------------------------------------------------------
+//
+// The smallest rectangle holding every pixel that differs between two
+// images of the same size and format, or a null rectangle if they match.
+// Whole rows are compared with memcmp(), and only the rows between the
+// first and last that differ are searched for the changed columns.
+//
+// ------------------------------------------------------------------------
 
-    switch (m_style)
+QRect
+changedRect(
+    const QImage& previous,
+    const QImage& current)
+{
+    const auto height = current.height();
+    const auto rowBytes = ((current.width() * current.depth()) + 7) / 8;
+
+    const auto rowChanged = [&](int j)
+    {
+        return std::memcmp(previous.constScanLine(j), current.constScanLine(j), rowBytes) != 0;
+    };
+
+    auto top = 0;
+
+    while ((top < height) and not rowChanged(top))
+    {
+        ++top;
+    }
+
+    if (top == height)
+    {
+        return QRect{};
+    }
+
+    auto bottom = height - 1;
+
+    while (not rowChanged(bottom))
+    {
+        --bottom;
+    }
+
+    auto left = rowBytes - 1;
+    auto right = 0;
+
+    for (auto j = top ; j <= bottom ; ++j)
     {
-        case HISTOGRAM_RGB:
+        const auto* previousRow = previous.constScanLine(j);
+        const auto* currentRow = current.constScanLine(j);
 
-            if (m_image.format() == QImage::Format_Grayscale8)
+        for (auto i = 0 ; i < left ; ++i)
+        {
+            if (previousRow[i] != currentRow[i])
             {
-                m_image = ::histogramIntensity(image);
+                left = i;
+                break;
             }
-            else
+        }
+
+        for (auto i = rowBytes - 1 ; i > right ; --i)
+        {
+            if (previousRow[i] != currentRow[i])
             {
-                m_image = ::histogramRGB(image);
+                right = i;
+                break;
             }
+        }
+    }
+
+    if (current.depth() < 8)
+    {
+        return QRect{0, top, current.width(), bottom - top + 1};
+    }
 
-            break;
+    const auto bytesPerPixel = current.depth() / 8;
 
-        case HISTOGRAM_INTENSITY:
+    return QRect{QPoint{left / bytesPerPixel, top}, QPoint{right / bytesPerPixel, bottom}};
+}
 
-            m_image = ::histogramIntensity(image);
-            break;
+// ------------------------------------------------------------------------
+
+}
 
-        case HISTOGRAM_OFF:
+// ========================================================================
+
+Histogram::Histogram()
+{
+    QObject::connect(&m_refinement,
+                     &QFutureWatcher<HistogramCounts>::finished,
+                     [this]() { refined(); });
+    QObject::connect(&m_storeLoad,
+                     &QFutureWatcher<std::optional<HistogramCounts>>::finished,
+                     [this]() { loaded(); });
+}
 
-            m_image = QImage{};
-            break;
+// ------------------------------------------------------------------------
+
+void
+Histogram::cache(const QString& key)
+{
+    if (not key.isEmpty())
+    {
+        m_cache.insert(styleKey(key, m_countedIntensity), m_counts);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+bool
+Histogram::cached(
+    const QString& key,
+    const QImage& image)
+{
+    if (key.isEmpty())
+    {
+        return false;
+    }
+
+    const auto intensity = countsIntensity(image);
+    const auto counts = m_cache.find(styleKey(key, intensity));
+
+    if (not counts)
+    {
+        return false;
+    }
+
+    m_counts = *counts;
+    m_counted = image;
+    m_countedIntensity = intensity;
+
+    return true;
+}
+
+// ------------------------------------------------------------------------
+
+bool
+Histogram::countsIntensity(const QImage& image) const noexcept
+{
+    // Grey images only have intensity to show.
+
+    return (m_style == HISTOGRAM_INTENSITY) or
+           (image.format() == QImage::Format_Grayscale8) or
+           (image.format() == QImage::Format_Grayscale16);
+}
+
+// ------------------------------------------------------------------------
+
+void
+Histogram::process(
+    const HistogramCounts& counts,
+    const QString& key)
+{
+    if (m_isValid)
+    {
+        return;
+    }
+
+    m_isValid = true;
+    ++m_generation;
+
+    // The counts are of an image this class never sees, so they cannot be
+    // updated by a later frame.
+
+    m_counted = QImage{};
+
+    if (m_style == HISTOGRAM_OFF)
+    {
+        m_image = QImage{};
+        return;
     }
+
+    m_counts = counts;
+    m_countedIntensity = (m_style == HISTOGRAM_INTENSITY);
+    m_image = renderCounts(m_counts, m_countedIntensity);
+    cache(key);
+}
+
+// ------------------------------------------------------------------------
+
+void
+Histogram::process(
+    const QImage& image,
+    const QString& key)
+{
+    if (m_isValid)
+    {
+        return;
+    }
+
+    m_isValid = true;
+    ++m_generation;
+
+    if (m_style == HISTOGRAM_OFF)
+    {
+        m_counted = QImage{};
+        m_image = QImage{};
+        return;
+    }
+
+    const auto intensity = countsIntensity(image);
+
+    if (cached(key, image))
+    {
+        m_image = renderCounts(m_counts, intensity);
+        return;
+    }
+
+    if (update(image))
+    {
+        m_image = renderCounts(m_counts, intensity);
+        cache(key);
+        return;
+    }
+
+    const auto step = histogramSampleStep(image);
+
+    m_counts = countImage(image, intensity, step);
+    m_counted = (step == 1) ? image : QImage{};
+    m_countedIntensity = intensity;
+    m_image = renderCounts(m_counts, intensity);
+
+    if (step == 1)
+    {
+        cache(key);
+    }
+    else
+    {
+        m_refinementGeneration = m_generation;
+        m_refinementImage = image;
+        m_refinementKey = key;
+        m_refinement.setFuture(QtConcurrent::run([image, intensity]()
+        {
+            return countImage(image, intensity, 1);
+        }));
+
+        if (m_cache.hasStore() and not key.isEmpty())
+        {
+            m_storeLoadGeneration = m_generation;
+            m_storeLoadKey = styleKey(key, intensity);
+            m_storeLoad.setFuture(m_cache.load(m_storeLoadKey));
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void
+Histogram::loaded()
+{
+    // Stored counts are only of use while the exact count they stand in
+    // for is still running, and for the image they were loaded for.
+
+    const auto counts = m_storeLoad.result();
+
+    if (counts and
+        m_isValid and
+        (m_storeLoadGeneration == m_generation) and
+        (m_refinementGeneration == m_generation) and
+        not m_refinementImage.isNull())
+    {
+        m_counts = *counts;
+        m_counted = m_refinementImage;
+        m_image = renderCounts(m_counts, m_countedIntensity);
+        m_cache.restore(m_storeLoadKey, m_counts);
+
+        // The exact count is no longer needed, nor stored again.
+
+        m_refinementGeneration = -1;
+
+        if (m_refinedCallback)
+        {
+            m_refinedCallback();
+        }
+    }
+
+    m_storeLoadKey = QString{};
+}
+
+// ------------------------------------------------------------------------
+
+void
+Histogram::refined()
+{
+    // Ignore the exact histogram if the image or style has changed since
+    // it was started.
+
+    if (m_isValid and (m_refinementGeneration == m_generation))
+    {
+        m_counts = m_refinement.result();
+        m_counted = m_refinementImage;
+        m_image = renderCounts(m_counts, m_countedIntensity);
+        cache(m_refinementKey);
+
+        if (m_refinedCallback)
+        {
+            m_refinedCallback();
+        }
+    }
+
+    m_refinementImage = QImage{};
+    m_refinementKey = QString{};
+}
+
+// ------------------------------------------------------------------------
+
+std::optional<ImageStatistics>
+Histogram::statistics() const
+{
+    if (not m_isValid or (m_style == HISTOGRAM_OFF) or m_image.isNull())
+    {
+        return std::nullopt;
+    }
+
+    return imageStatistics(m_counts, m_countedIntensity);
+}
+
+// ------------------------------------------------------------------------
+//
+// Update the exact counts of the previous frame to those of image, by
+// subtracting the counts of the changed rectangle in the previous frame
+// and adding those of the same rectangle in this one. Returns false,
+// leaving the counts alone, if there are no counts to update or the
+// change covers more than half the frame.
+//
+// ------------------------------------------------------------------------
+
+bool
+Histogram::update(const QImage& image)
+{
+    if (m_counted.isNull() or
+        (m_counted.size() != image.size()) or
+        (m_counted.format() != image.format()) or
+        (m_countedIntensity != countsIntensity(image)))
+    {
+        return false;
+    }
+
+    const auto changed = changedRect(m_counted, image);
+    const auto changedArea = static_cast<qint64>(changed.width()) * changed.height();
+    const auto area = static_cast<qint64>(image.width()) * image.height();
+
+    if ((2 * changedArea) > area)
+    {
+        return false;
+    }
+
+    if (not changed.isNull())
+    {
+        subtract(m_counts, countImage(m_counted.copy(changed), m_countedIntensity, 1));
+        add(m_counts, countImage(image.copy(changed), m_countedIntensity, 1));
+    }
+
+    m_counted = image;
+
+    return true;
 }
 
 // ------------------------------------------------------------------------
@@ -100,7 +489,7 @@ Histogram::toggle() noexcept
         break;
     }
 
-    m_isValid = false;
+    invalidate();
 }
 
 // ========================================================================
@@ -109,12 +498,6 @@ namespace
 {
 
 // -------------------------------------------------------------------------
-struct RGBCount
-{
-    int r{0};
-    int g{0};
-    int b{0};
-};
 
 static constexpr int HistogramAlpha{191};
 static constexpr int HistogramHeight{128};
@@ -122,7 +505,129 @@ static constexpr int ColourValues{256};
 static constexpr int BackgroundBrightness{63};
 static constexpr int HistogramBrightness{255};
 
-using RGBCountArray = std::array<RGBCount, ColourValues>;
+// -------------------------------------------------------------------------
+//
+// The overlay is drawn from eight premultiplied colours, indexed by which
+// of the red, green and blue bars reach a pixel. Columns are written
+// straight into a copy of the cached background.
+//
+// -------------------------------------------------------------------------
+
+static constexpr int RedBar{4};
+static constexpr int GreenBar{2};
+static constexpr int BlueBar{1};
+static constexpr int AllBars{RedBar | GreenBar | BlueBar};
+
+using OverlayColourArray = std::array<QRgb, AllBars + 1>;
+
+constexpr OverlayColourArray
+overlayColours()
+{
+    OverlayColourArray colours{};
+
+    for (auto bars = 0 ; bars <= AllBars ; ++bars)
+    {
+        const auto level = [bars](int bar)
+        {
+            const auto brightness = (bars & bar)
+                                  ? HistogramBrightness
+                                  : BackgroundBrightness;
+
+            return ((brightness * HistogramAlpha) + 127) / 255;
+        };
+
+        colours[bars] = qRgba(level(RedBar), level(GreenBar), level(BlueBar), HistogramAlpha);
+    }
+
+    return colours;
+}
+
+static constexpr OverlayColourArray OverlayColours{overlayColours()};
+
+// -------------------------------------------------------------------------
+
+QImage
+overlayBackground()
+{
+    static const QImage background = []()
+    {
+        QImage image{ColourValues, HistogramHeight, QImage::Format_ARGB32_Premultiplied};
+        image.fill(OverlayColours[0]);
+
+        return image;
+    }();
+
+    return background;
+}
+
+// -------------------------------------------------------------------------
+
+int
+barHeight(
+    int count,
+    int max)
+{
+    const auto height = (static_cast<std::int64_t>(count) * HistogramHeight) / max;
+
+    return static_cast<int>(std::min<std::int64_t>(height, HistogramHeight - 1));
+}
+
+// -------------------------------------------------------------------------
+
+QRgb&
+overlayPixel(
+    const ScanLines& output,
+    int i,
+    int j)
+{
+    return reinterpret_cast<QRgb*>(output[HistogramHeight - 1 - j])[i];
+}
+
+// -------------------------------------------------------------------------
+//
+// Consecutive pixels are counted into separate banks, which are summed at
+// the end. In flat areas neighbouring pixels share a value, and counting
+// them into one array would make each increment wait for the store of the
+// one before it.
+//
+// -------------------------------------------------------------------------
+
+static constexpr int CountBanks{4};
+
+template<typename CountArray>
+using CountBanksArray = std::array<CountArray, CountBanks>;
+
+// -------------------------------------------------------------------------
+//
+// Sampled histograms aim for HistogramSamples samples. The column offset
+// of each sampled row steps through the golden ratio sequence.
+//
+// -------------------------------------------------------------------------
+
+static constexpr double HistogramSamples{1 << 20};
+static constexpr double GoldenRatioConjugate{0.6180339887498949};
+
+// -------------------------------------------------------------------------
+
+int
+firstSampleRow(
+    int jStart,
+    int step)
+{
+    return jStart + ((step / 2) - (jStart % step) + step) % step;
+}
+
+// -------------------------------------------------------------------------
+
+int
+firstSampleColumn(
+    int j,
+    int step)
+{
+    const auto jitter = std::fmod((j / step) * GoldenRatioConjugate, 1.0);
+
+    return static_cast<int>(jitter * step);
+}
 
 // -------------------------------------------------------------------------
 
@@ -142,38 +647,85 @@ add(
 // -------------------------------------------------------------------------
 
 void
-histogramColourRow(
-    int j,
-    const QImage& input,
-    RGBCountArray& count)
+add(
+    IntensityCountArray& target,
+    const IntensityCountArray& source)
+{
+    for (auto i = 0 ; i < ColourValues ; ++i)
+    {
+        target[i] += source[i];
+    }
+}
+
+// -------------------------------------------------------------------------
+
+template<typename CountArray>
+CountArray
+merge(
+    const CountBanksArray<CountArray>& banks)
+{
+    CountArray counts{};
+
+    for (const auto& bank : banks)
+    {
+        add(counts, bank);
+    }
+
+    return counts;
+}
+
+// -------------------------------------------------------------------------
+//
+// Count a row of Grayscale8 pixels eight at a time: each 64 bit load is
+// unpacked into bytes with shifts, two pixels to each bank.
+//
+// -------------------------------------------------------------------------
+
+void
+histogramGreyRowGrey8(
+    const uchar* pixel,
+    int width,
+    CountBanksArray<IntensityCountArray>& banks)
 {
-    const auto width = input.width();
-    for (auto i = 0 ; i < width ; ++i)
+    auto i = 0;
+
+    for ( ; i + 8 <= width ; i += 8)
     {
-        auto colour = input.pixelColor(i, j);
-        const auto r = colour.red() * colour.alpha() / 255;
-        const auto g = colour.green() * colour.alpha() / 255;
-        const auto b = colour.blue() * colour.alpha() / 255;
-        ++(count[r].r);
-        ++(count[g].g);
-        ++(count[b].b);
+        std::uint64_t bytes;
+        std::memcpy(&bytes, pixel + i, sizeof(bytes));
+
+        ++(banks[0][bytes & 0xFF]);
+        ++(banks[1][(bytes >> 8) & 0xFF]);
+        ++(banks[2][(bytes >> 16) & 0xFF]);
+        ++(banks[3][(bytes >> 24) & 0xFF]);
+        ++(banks[0][(bytes >> 32) & 0xFF]);
+        ++(banks[1][(bytes >> 40) & 0xFF]);
+        ++(banks[2][(bytes >> 48) & 0xFF]);
+        ++(banks[3][bytes >> 56]);
+    }
+
+    for ( ; i < width ; ++i)
+    {
+        ++(banks[0][pixel[i]]);
     }
 }
 
 // -------------------------------------------------------------------------
 
+template<typename Accessor>
 void
-histogramColourRowARGB32(
-    int row,
-    const QImage& input,
+countColour(
+    QRgb rgb,
     RGBCountArray& count)
 {
-    const auto width = input.width();
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(row));
-
-    for (auto i = 0 ; i < width ; ++i)
+    if constexpr (Accessor::isPremultiplied)
+    {
+        ++(count[qRed(rgb)].r);
+        ++(count[qGreen(rgb)].g);
+        ++(count[qBlue(rgb)].b);
+    }
+    else
     {
-        auto rgb = *(pixel++);
         const auto r = (qRed(rgb) * qAlpha(rgb)) / 255;
         const auto g = (qGreen(rgb) * qAlpha(rgb)) / 255;
         const auto b = (qBlue(rgb) * qAlpha(rgb)) / 255;
@@ -185,365 +737,436 @@ histogramColourRowARGB32(
 
 // -------------------------------------------------------------------------
 
+template<typename Accessor>
 void
-histogramColourRowRGB32(
-    int row,
-    const QImage& input,
-    RGBCountArray& count)
+countIntensity(
+    QRgb rgb,
+    IntensityCountArray& count)
 {
-    const auto width = input.width();
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(row));
-
-    for (auto i = 0 ; i < width ; ++i)
+    if constexpr (Accessor::isGrey)
     {
-        auto rgb = *(pixel++);
-        const auto r = qRed(rgb);
-        const auto g = qGreen(rgb);
-        const auto b = qBlue(rgb);
-        ++(count[r].r);
-        ++(count[g].g);
-        ++(count[b].b);
+        ++(count[qBlue(rgb)]);
+    }
+    else if constexpr (Accessor::isPremultiplied)
+    {
+        ++(count[qGray(rgb)]);
+    }
+    else
+    {
+        ++(count[(qGray(rgb) * qAlpha(rgb)) / 255]);
     }
 }
 
 // -------------------------------------------------------------------------
 
+template<typename Accessor>
 void
-histogramColourRowGrey8(
-    int row,
-    const QImage& input,
+countColour(
+    QRgba64 rgba,
     RGBCountArray& count)
 {
-    const auto width = input.width();
-    const auto* pixel = input.constScanLine(row);
+    // 16 bit values are binned by their top eight bits.
 
-    for (auto i = 0 ; i < width ; ++i)
+    if constexpr (Accessor::isPremultiplied)
     {
-        const auto intensity = *(pixel++);
-        ++(count[intensity].r);
-        ++(count[intensity].g);
-        ++(count[intensity].b);
+        ++(count[rgba.red() >> 8].r);
+        ++(count[rgba.green() >> 8].g);
+        ++(count[rgba.blue() >> 8].b);
+    }
+    else
+    {
+        const auto alpha = static_cast<std::uint32_t>(rgba.alpha());
+        ++(count[((rgba.red() * alpha) / 0xFFFF) >> 8].r);
+        ++(count[((rgba.green() * alpha) / 0xFFFF) >> 8].g);
+        ++(count[((rgba.blue() * alpha) / 0xFFFF) >> 8].b);
     }
 }
 
 // -------------------------------------------------------------------------
 
-auto
-histogramColourRowFunction(
-    const QImage& input)
+template<typename Accessor>
+void
+countIntensity(
+    QRgba64 rgba,
+    IntensityCountArray& count)
 {
-    switch (input.format())
+    if constexpr (Accessor::isGrey)
     {
-        case QImage::Format_ARGB32:
-
-            return histogramColourRowARGB32;
-
-        case QImage::Format_RGB32:
-
-            return histogramColourRowRGB32;
-
-        case QImage::Format_Grayscale8:
-
-            return histogramColourRowGrey8;
-
-        default:
+        ++(count[rgba.red() >> 8]);
+    }
+    else
+    {
+        const auto grey = static_cast<std::uint32_t>(qGray(rgba.red(), rgba.green(), rgba.blue()));
 
-            return histogramColourRow;
+        if constexpr (Accessor::isPremultiplied)
+        {
+            ++(count[grey >> 8]);
+        }
+        else
+        {
+            ++(count[((grey * rgba.alpha()) / 0xFFFF) >> 8]);
+        }
     }
 }
 
+// -------------------------------------------------------------------------
+//
+// The row of pixels to count: at full precision for 16 bit formats.
+//
 // -------------------------------------------------------------------------
 
-RGBCountArray
-histogramColourCount(
-    int jStart,
-    int jEnd,
-    const QImage& input)
+template<typename Accessor>
+auto
+countedRow(
+    const Accessor& accessor,
+    int j)
 {
-    RGBCountArray counts{};
-    auto rowFunction = histogramColourRowFunction(input);
-
-    for (auto j = jStart ; j < jEnd ; ++j)
+    if constexpr (Accessor::isWide)
     {
-        rowFunction(j, input, counts);
+        return accessor.wideRow(j);
+    }
+    else
+    {
+        return accessor.row(j);
     }
-
-    return counts;
 }
 
 // -------------------------------------------------------------------------
 
-};
-
-// ========================================================================
-
-QImage
-histogramRGB(
-    const QImage& input)
+template<typename Accessor>
+void
+histogramColourRow(
+    int j,
+    int width,
+    const Accessor& accessor,
+    CountBanksArray<RGBCountArray>& banks)
 {
-    const auto height = input.height();
-    RGBCountArray counts{};
-
-    QImage output{ColourValues, HistogramHeight, QImage::Format_ARGB32};
-    const auto threads = concurrentRowSlice(input);
+    const auto pixel = countedRow(accessor, j);
+    auto i = 0;
 
-    if (threads)
+    for ( ; i + CountBanks <= width ; i += CountBanks)
     {
-        const auto rowsPerCore = height / *threads;
-        QFutureSynchronizer<RGBCountArray> synchronizer;
-        auto runner = [=, &input](int jStart, int jEnd) -> auto
-        {
-            return histogramColourCount(jStart, jEnd, input);
-        };
-
-        for (auto thread = 0 ; thread < *threads ; ++thread)
-        {
-            const auto jStart = thread * rowsPerCore;
-            const auto jEnd = (thread == *threads - 1) ? height : (jStart + rowsPerCore);
-
-            synchronizer.addFuture(QtConcurrent::run(runner, jStart, jEnd));
-        }
-
-        synchronizer.waitForFinished();
-
-        for (const auto& future : synchronizer.futures())
+        for (auto bank = 0 ; bank < CountBanks ; ++bank)
         {
-            add(counts, future.result());
+            countColour<Accessor>(pixel(i + bank), banks[bank]);
         }
     }
-    else
+
+    for ( ; i < width ; ++i)
     {
-        add(counts, histogramColourCount(0, height, input));
+        countColour<Accessor>(pixel(i), banks[0]);
     }
+}
 
-    int max{};
+// -------------------------------------------------------------------------
 
-    for (const auto& count : counts)
+template<typename Accessor>
+void
+histogramGreyRow(
+    int j,
+    int width,
+    const Accessor& accessor,
+    CountBanksArray<IntensityCountArray>& banks)
+{
+    if constexpr (std::is_same_v<Accessor, PixelGrey8>)
     {
-        max = std::max({max, count.r, count.g, count.b});
+        histogramGreyRowGrey8(accessor.line(j), width, banks);
     }
-
-    for (auto i = 0 ; i < ColourValues ; ++i)
+    else
     {
-        const auto r = (counts[i].r * HistogramHeight) / max;
-        const auto g = (counts[i].g * HistogramHeight) / max;
-        const auto b = (counts[i].b * HistogramHeight) / max;
+        const auto pixel = countedRow(accessor, j);
+        auto i = 0;
 
-        for (auto j = 0 ; j < HistogramHeight ; ++j)
+        for ( ; i + CountBanks <= width ; i += CountBanks)
         {
-            const QColor color(
-                r >= j ? HistogramBrightness : BackgroundBrightness,
-                g >= j ? HistogramBrightness : BackgroundBrightness,
-                b >= j ? HistogramBrightness : BackgroundBrightness,
-                HistogramAlpha);
-            output.setPixelColor(i, HistogramHeight - 1 - j, color);
-
+            for (auto bank = 0 ; bank < CountBanks ; ++bank)
+            {
+                countIntensity<Accessor>(pixel(i + bank), banks[bank]);
             }
-    }
+        }
 
-    return output;
+        for ( ; i < width ; ++i)
+        {
+            countIntensity<Accessor>(pixel(i), banks[0]);
+        }
+    }
 }
 
-// ========================================================================
-namespace
-{
-
-// -------------------------------------------------------------------------
-
-using IntensityCountArray = std::array<int, ColourValues>;
-
 // -------------------------------------------------------------------------
 
+template<typename Accessor>
 void
-add(
-    IntensityCountArray& target,
-    const IntensityCountArray& source)
+histogramColourRowSampled(
+    int j,
+    int width,
+    int step,
+    const Accessor& accessor,
+    CountBanksArray<RGBCountArray>& banks)
 {
-    for (auto i = 0 ; i < ColourValues ; ++i)
+    const auto pixel = countedRow(accessor, j);
+    auto bank = 0;
+
+    for (auto i = firstSampleColumn(j, step) ; i < width ; i += step)
     {
-        target[i] += source[i];
+        countColour<Accessor>(pixel(i), banks[bank]);
+        bank = (bank + 1) % CountBanks;
     }
 }
 
 // -------------------------------------------------------------------------
 
+template<typename Accessor>
 void
-histogramGreyRow(
+histogramGreyRowSampled(
     int j,
-    const QImage& input,
-    IntensityCountArray& count)
+    int width,
+    int step,
+    const Accessor& accessor,
+    CountBanksArray<IntensityCountArray>& banks)
 {
-    const auto width = input.width();
-    for (auto i = 0 ; i < width ; ++i)
+    const auto pixel = countedRow(accessor, j);
+    auto bank = 0;
+
+    for (auto i = firstSampleColumn(j, step) ; i < width ; i += step)
     {
-        auto rgb = input.pixelColor(i, j).rgb();
-        const auto intensity = qGray(rgb) * qAlpha(rgb) / 255;
-        ++(count[intensity]);
+        countIntensity<Accessor>(pixel(i), banks[bank]);
+        bank = (bank + 1) % CountBanks;
     }
 }
 
 // -------------------------------------------------------------------------
 
-void
-histogramGreyRowARGB32(
-    int row,
+IntensityCountArray
+histogramGreyCount(
+    int jStart,
+    int jEnd,
     const QImage& input,
-    IntensityCountArray& count)
+    int step)
 {
+    CountBanksArray<IntensityCountArray> banks{};
     const auto width = input.width();
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(row));
 
-    for (auto i = 0 ; i < width ; ++i)
+    withPixelAccessor(input, [=, &banks](const auto& accessor)
     {
-        auto rgb = *(pixel++);
-        const auto intensity = (qGray(rgb) * qAlpha(rgb)) / 255;
-        ++(count[intensity]);
-    }
+        for (auto j = firstSampleRow(jStart, step) ; j < jEnd ; j += step)
+        {
+            if (step == 1)
+            {
+                histogramGreyRow(j, width, accessor, banks);
+            }
+            else
+            {
+                histogramGreyRowSampled(j, width, step, accessor, banks);
+            }
+        }
+    });
 
+    return merge(banks);
 }
 
 // -------------------------------------------------------------------------
 
-void
-histogramGreyRowRGB32(
-    int row,
+RGBCountArray
+histogramColourCount(
+    int jStart,
+    int jEnd,
     const QImage& input,
-    IntensityCountArray& count)
+    int step)
 {
     const auto width = input.width();
-    const auto* pixel = reinterpret_cast<const QRgb*>(input.constScanLine(row));
+    const auto isGrey = withPixelAccessor(input, [](const auto& accessor)
+    {
+        return std::decay_t<decltype(accessor)>::isGrey;
+    });
 
-    for (auto i = 0 ; i < width ; ++i)
+    if (isGrey)
     {
-        auto rgb = *(pixel++);
-        const auto intensity = qGray(rgb);
-        ++(count[intensity]);
+        // The red, green and blue counts of a grey image are all the
+        // intensity count.
+
+        const auto intensity = histogramGreyCount(jStart, jEnd, input, step);
+        RGBCountArray counts{};
+
+        for (auto i = 0 ; i < ColourValues ; ++i)
+        {
+            counts[i] = RGBCount{intensity[i], intensity[i], intensity[i]};
+        }
+
+        return counts;
     }
+
+    CountBanksArray<RGBCountArray> banks{};
+
+    withPixelAccessor(input, [=, &banks](const auto& accessor)
+    {
+        for (auto j = firstSampleRow(jStart, step) ; j < jEnd ; j += step)
+        {
+            if (step == 1)
+            {
+                histogramColourRow(j, width, accessor, banks);
+            }
+            else
+            {
+                histogramColourRowSampled(j, width, step, accessor, banks);
+            }
+        }
+    });
+
+    return merge(banks);
 }
 
 // -------------------------------------------------------------------------
 
+};
+
+// ========================================================================
+
 void
-histogramGreyRowGrey8(
-    int row,
-    const QImage& input,
-    IntensityCountArray& count)
+add(
+    HistogramCounts& target,
+    const HistogramCounts& source)
 {
-    const auto width = input.width();
-    const auto* pixel = input.constScanLine(row);
-
-    for (auto i = 0 ; i < width ; ++i)
-    {
-        const auto intensity = *(pixel++);
-        ++(count[intensity]);
-    }
+    add(target.rgb, source.rgb);
+    add(target.intensity, source.intensity);
 }
 
-// -------------------------------------------------------------------------
+// ========================================================================
 
-auto
-histogramGreyRowFunction(
+int
+histogramSampleStep(
     const QImage& input)
 {
-    switch (input.format())
-    {
-        case QImage::Format_ARGB32:
+    const auto pixels = static_cast<double>(input.width()) * input.height();
 
-            return histogramGreyRowARGB32;
-
-        case QImage::Format_RGB32:
-
-            return histogramGreyRowRGB32;
+    return std::max(1, static_cast<int>(std::sqrt(pixels / HistogramSamples)));
+}
 
-        case QImage::Format_Grayscale8:
+// ========================================================================
 
-            return histogramGreyRowGrey8;
+QImage
+histogramRGB(
+    const QImage& input,
+    int step)
+{
+    return histogramRGB(histogramRGBCounts(input, step));
+}
 
-        default:
+// ------------------------------------------------------------------------
 
-            return histogramGreyRow;
-    }
+RGBCountArray
+histogramRGBCounts(
+    const QImage& input,
+    int step)
+{
+    return concurrentRowsReduce<RGBCountArray>(
+        (step == 1) ? "histogram rgb" : "histogram rgb sampled",
+        input,
+        [&input, step](int jStart, int jEnd)
+        {
+            return histogramColourCount(jStart, jEnd, input, step);
+        },
+        [](RGBCountArray& target, const RGBCountArray& source)
+        {
+            add(target, source);
+        });
 }
 
-// -------------------------------------------------------------------------
+// ------------------------------------------------------------------------
 
-IntensityCountArray
-histogramGreyCount(
-    int jStart,
-    int jEnd,
-    const QImage& input)
+QImage
+histogramRGB(
+    const RGBCountArray& counts)
 {
-    IntensityCountArray counts{};
-    auto rowFunction = histogramGreyRowFunction(input);
+    int max{};
 
-    for (auto j = jStart ; j < jEnd ; ++j)
+    for (const auto& count : counts)
     {
-        rowFunction(j, input, counts);
+        max = std::max({max, count.r, count.g, count.b});
     }
 
-    return counts;
-}
+    auto output = overlayBackground();
 
-// -------------------------------------------------------------------------
+    if (max == 0)
+    {
+        return output;
+    }
 
-};
+    const ScanLines outputLines{output};
+
+    for (auto i = 0 ; i < ColourValues ; ++i)
+    {
+        const auto r = barHeight(counts[i].r, max);
+        const auto g = barHeight(counts[i].g, max);
+        const auto b = barHeight(counts[i].b, max);
+        const auto top = std::max({r, g, b});
+
+        for (auto j = 0 ; j <= top ; ++j)
+        {
+            const auto bars = ((r >= j) ? RedBar : 0)
+                            | ((g >= j) ? GreenBar : 0)
+                            | ((b >= j) ? BlueBar : 0);
+            overlayPixel(outputLines, i, j) = OverlayColours[bars];
+        }
+    }
+
+    return output;
+}
 
 // ========================================================================
 
 QImage
 histogramIntensity(
-    const QImage& input)
+    const QImage& input,
+    int step)
 {
-    const auto height = input.height();
-    IntensityCountArray counts{};
-
-    QImage output{ColourValues, HistogramHeight, QImage::Format_ARGB32};
+    return histogramIntensity(histogramIntensityCounts(input, step));
+}
 
-    const auto threads = concurrentRowSlice(input);
+// ------------------------------------------------------------------------
 
-    if (threads)
-    {
-        const auto rowsPerCore = height / *threads;
-        QFutureSynchronizer<IntensityCountArray> synchronizer;
-        auto runner = [=, &input](int jStart, int jEnd) -> auto
+IntensityCountArray
+histogramIntensityCounts(
+    const QImage& input,
+    int step)
+{
+    return concurrentRowsReduce<IntensityCountArray>(
+        (step == 1) ? "histogram intensity" : "histogram intensity sampled",
+        input,
+        [&input, step](int jStart, int jEnd)
         {
-            return histogramGreyCount(jStart, jEnd, input);
-        };
-
-        for (auto thread = 0 ; thread < *threads ; ++thread)
+            return histogramGreyCount(jStart, jEnd, input, step);
+        },
+        [](IntensityCountArray& target, const IntensityCountArray& source)
         {
-            const auto jStart = thread * rowsPerCore;
-            const auto jEnd = (thread == *threads - 1) ? height : (jStart + rowsPerCore);
+            add(target, source);
+        });
+}
 
-            synchronizer.addFuture(QtConcurrent::run(runner, jStart, jEnd));
-        }
+// ------------------------------------------------------------------------
 
-        synchronizer.waitForFinished();
+QImage
+histogramIntensity(
+    const IntensityCountArray& counts)
+{
+    const auto max = std::ranges::max(counts);
+    auto output = overlayBackground();
 
-        for (const auto& future : synchronizer.futures())
-        {
-            add(counts, future.result());
-        }
-    }
-    else
+    if (max == 0)
     {
-        add(counts, histogramGreyCount(0, height, input));
+        return output;
     }
 
-    const auto max = std::ranges::max(counts);
+    const ScanLines outputLines{output};
 
     for (auto i = 0 ; i < ColourValues ; ++i)
     {
-        const auto rgb = (counts[i] * HistogramHeight) / max;
+        const auto top = barHeight(counts[i], max);
 
-        for (auto j = 0 ; j < HistogramHeight ; ++j)
+        for (auto j = 0 ; j <= top ; ++j)
         {
-            const auto c = (rgb >= j) ? HistogramBrightness : BackgroundBrightness;
-            const QColor color(c, c, c, HistogramAlpha);
-            output.setPixelColor(i, HistogramHeight - 1 - j, color);
+            overlayPixel(outputLines, i, j) = OverlayColours[AllBars];
         }
     }
 
     return output;
 }
-
@@ -27,8 +27,35 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QImage>
 
+#include "counts.h"
+#include "statistics.h"
+
+#include <functional>
+#include <optional>
+
+// ------------------------------------------------------------------------
+//
+// Large images are first histogrammed from a stratified sample of their
+// pixels (see histogramSampleStep()), which is quick enough to show the
+// overlay straight away. The exact histogram is then computed in the
+// background and replaces the approximation when it is ready, at which
+// point the refined callback is called.
+//
+// The exact counts are kept with the image they were taken from. When
+// frameChanged() rather than invalidate() marks the histogram out of date,
+// process() compares the new frame with that image and updates the counts
+// from the rectangle that changed, so that the cost of the overlay during
+// animation follows the size of the change rather than of the frame.
+//
+// Exact counts are also kept in a StatisticsCache under the key given to
+// process(), so returning to a recently viewed image does not count it
+// again. Counts stored by an earlier session are loaded in the background
+// alongside the exact count, and replace the approximation if they arrive
+// first. An empty key bypasses the cache.
+//
 // ------------------------------------------------------------------------
 
 class Histogram
@@ -42,22 +69,74 @@ public:
         HISTOGRAM_INTENSITY = 2
     };
 
+    Histogram();
+
+    Histogram(const Histogram&) = delete;
+    Histogram(Histogram &&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+    Histogram& operator=(Histogram &&) = delete;
+
+    void frameChanged() noexcept { m_isValid = false; ++m_generation; }
     [[nodiscard]] const QImage& image() const noexcept { return m_image; }
-    void invalidate() noexcept { m_isValid = false; }
+    void invalidate() noexcept { m_counted = QImage{}; frameChanged(); }
     [[nodiscard]] bool isValid() const noexcept { return m_isValid; }
+    [[nodiscard]] bool needsProcessing() const noexcept { return not m_isValid and (m_style != HISTOGRAM_OFF); }
+    void onRefined(std::function<void()> callback) { m_refinedCallback = std::move(callback); }
 
-    void process(const QImage& image);
+    void process(const HistogramCounts& counts, const QString& key = {});
+    void process(const QImage& image, const QString& key = {});
+    [[nodiscard]] std::optional<ImageStatistics> statistics() const;
     void toggle() noexcept;
 
 private:
 
+    void cache(const QString& key);
+    [[nodiscard]] bool cached(const QString& key, const QImage& image);
+    [[nodiscard]] bool countsIntensity(const QImage& image) const noexcept;
+    void loaded();
+    void refined();
+    [[nodiscard]] bool update(const QImage& image);
+
     QImage m_image{};
+    StatisticsCache m_cache{};
+    HistogramCounts m_counts{};
+    QImage m_counted{};
+    bool m_countedIntensity{false};
     bool m_isValid{false};
+    int m_generation{0};
+    std::function<void()> m_refinedCallback{};
+    QFutureWatcher<HistogramCounts> m_refinement{};
+    QImage m_refinementImage{};
+    QString m_refinementKey{};
+    int m_refinementGeneration{0};
+    QFutureWatcher<std::optional<HistogramCounts>> m_storeLoad{};
+    QString m_storeLoadKey{};
+    int m_storeLoadGeneration{0};
     Style m_style{HISTOGRAM_OFF};
 };
 
+// ------------------------------------------------------------------------
+//
+// With a step greater than one only the pixels on a step x step grid are
+// counted, one pixel from each cell: every step'th row, with a column
+// offset that varies from row to row so that regular patterns in the
+// image do not alias with the grid.
+//
+// histogramSampleStep() picks the step that leaves about 2^20 samples, and
+// returns 1 (exact counting) for images of up to about 4 megapixels. For
+// n samples, the standard error of the fraction of pixels in any one bin
+// is at most 1 / (2 * sqrt(n)), i.e. 0.05% of the pixels for n = 2^20.
+// As the overlay is scaled to its tallest bin, that is under one pixel of
+// the 128 pixel high overlay whenever the tallest bin holds more than
+// about 6% of the pixels.
+//
 // ------------------------------------------------------------------------
 
-QImage histogramRGB(const QImage& input);
-QImage histogramIntensity(const QImage& input);
+[[nodiscard]] int histogramSampleStep(const QImage& input);
 
+QImage histogramRGB(const QImage& input, int step = 1);
+QImage histogramRGB(const RGBCountArray& counts);
+RGBCountArray histogramRGBCounts(const QImage& input, int step = 1);
+QImage histogramIntensity(const QImage& input, int step = 1);
+QImage histogramIntensity(const IntensityCountArray& counts);
+IntensityCountArray histogramIntensityCounts(const QImage& input, int step = 1);
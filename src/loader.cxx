@@ -0,0 +1,239 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <QBuffer>
+#include <QImageReader>
+
+#include "loader.h"
+#include "pixel.h"
+#include "slice.h"
+
+#include <utility>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+
+struct Content
+{
+    bool hasColour{false};
+    bool hasTransparency{false};
+};
+
+// ------------------------------------------------------------------------
+
+template<typename Accessor>
+void
+contentRow(
+    int j,
+    int width,
+    const Accessor& accessor,
+    Content& content)
+{
+    const auto pixel = accessor.row(j);
+
+    for (auto i = 0 ; i < width ; ++i)
+    {
+        const auto rgb = pixel(i);
+
+        if constexpr (not Accessor::isGrey)
+        {
+            if ((qRed(rgb) != qGreen(rgb)) or (qGreen(rgb) != qBlue(rgb)))
+            {
+                content.hasColour = true;
+            }
+        }
+
+        if (qAlpha(rgb) != 255)
+        {
+            content.hasTransparency = true;
+        }
+
+        if (content.hasColour and content.hasTransparency)
+        {
+            return;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+Content
+contentRange(
+    int jStart,
+    int jEnd,
+    const QImage& image)
+{
+    Content content{};
+    const auto width = image.width();
+
+    withPixelAccessor(image, [&](const auto& accessor)
+    {
+        for (auto j = jStart ; j < jEnd ; ++j)
+        {
+            contentRow(j, width, accessor, content);
+
+            if (content.hasColour and content.hasTransparency)
+            {
+                return;
+            }
+        }
+    });
+
+    return content;
+}
+
+// ------------------------------------------------------------------------
+
+Content
+imageContent(
+    const QImage& image)
+{
+    if (image.format() == QImage::Format_Grayscale8)
+    {
+        return Content{};
+    }
+
+    return concurrentRowsReduce<Content>(
+        "content",
+        image,
+        [&image](int jStart, int jEnd)
+        {
+            return contentRange(jStart, jEnd, image);
+        },
+        [](Content& target, const Content& source)
+        {
+            target.hasColour = target.hasColour or source.hasColour;
+            target.hasTransparency = target.hasTransparency or source.hasTransparency;
+        });
+}
+
+// ------------------------------------------------------------------------
+
+QImage
+highBitDepthImage(
+    QImage image,
+    Content content)
+{
+    if (content.hasTransparency)
+    {
+        return std::move(image).convertToFormat(QImage::Format_RGBA64_Premultiplied);
+    }
+
+    if (not content.hasColour)
+    {
+        return std::move(image).convertToFormat(QImage::Format_Grayscale16);
+    }
+
+    return std::move(image).convertToFormat(QImage::Format_RGBX64);
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+LoadedImage
+loadImage(
+    const QString& path,
+    int frame,
+    bool isNewImage)
+{
+    QImageReader reader{path};
+    const auto frameCount = reader.imageCount();
+
+    for (auto i = 0 ; i < frame ; ++i)
+    {
+        reader.read();
+    }
+
+    return LoadedImage{workingImage(reader.read()), path, frame, frameCount, isNewImage};
+}
+
+// ------------------------------------------------------------------------
+
+QImage
+workingImage(
+    QImage image)
+{
+    if (image.isNull())
+    {
+        return image;
+    }
+
+    const auto content = imageContent(image);
+
+    // The image is taken by value so that the conversions below can
+    // happen in place where Qt supports it.
+
+    if ((image.depth() > 32) or (image.format() == QImage::Format_Grayscale16))
+    {
+        return highBitDepthImage(std::move(image), content);
+    }
+
+    if (content.hasTransparency)
+    {
+        return std::move(image).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    if (not content.hasColour)
+    {
+        return std::move(image).convertToFormat(QImage::Format_Grayscale8);
+    }
+
+    if (image.format() == QImage::Format_ARGB32)
+    {
+        // Every pixel is opaque, so the pixels are already valid RGB32.
+
+        image.reinterpretAsFormat(QImage::Format_RGB32);
+        return image;
+    }
+
+    return std::move(image).convertToFormat(QImage::Format_RGB32);
+}
+
+// ------------------------------------------------------------------------
+
+void
+warmUpImageReaders()
+{
+    // Asking a reader whether it can read an empty buffer is enough to
+    // make it load the plugin that handles its format.
+
+    QByteArray empty;
+
+    for (const auto& format : QImageReader::supportedImageFormats())
+    {
+        QBuffer buffer(&empty);
+        QImageReader reader(&buffer, format);
+        static_cast<void>(reader.canRead());
+    }
+}
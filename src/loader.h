@@ -0,0 +1,76 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+// ------------------------------------------------------------------------
+
+struct LoadedImage
+{
+    QImage image{};
+    QString path{};
+    int frame{0};
+    int frameCount{1};
+    bool isNewImage{true};
+};
+
+// ------------------------------------------------------------------------
+//
+// Decode a frame of an image file and convert it to its working format.
+// Intended to be run on a worker thread.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] LoadedImage loadImage(const QString& path, int frame, bool isNewImage);
+
+// ------------------------------------------------------------------------
+//
+// The working format is the one every kernel has its fastest path for,
+// and which QPainter can draw without converting: Format_Grayscale8 for
+// opaque images with no colour, Format_RGB32 for other opaque images and
+// Format_ARGB32_Premultiplied for images with transparency. The decoded
+// original is not kept.
+//
+// Images with more than eight bits per channel keep sixteen, in
+// Format_Grayscale16, Format_RGBX64 or Format_RGBA64_Premultiplied, and
+// are only reduced to eight when they are displayed.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] QImage workingImage(QImage image);
+
+// ------------------------------------------------------------------------
+//
+// Load every image format plugin, which Qt otherwise does on the first
+// decode that needs it. Intended to be run on a worker thread at startup.
+//
+// ------------------------------------------------------------------------
+
+void warmUpImageReaders();
@@ -26,17 +26,64 @@
 //-------------------------------------------------------------------------
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImageReader>
 #include <QPalette>
+#include <QThreadPool>
 
 #include "ShowImage.h"
+#include "batch.h"
+#include "loader.h"
+#include "slice.h"
+
+#include <iostream>
 
 // ------------------------------------------------------------------------
 
 int main(int argc, char* argv[])
 {
+    if (isBatch(argc, argv))
+    {
+        return batchMain(argc, argv);
+    }
+
+    QElapsedTimer startup;
+    startup.start();
+
     QApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Image viewer");
+    parser.addHelpOption();
+
+    const QCommandLineOption measureStartup("measure-startup",
+                                            "Print the time to the first paint, then exit.");
+    parser.addOption(measureStartup);
+
+    // Only listed here for --help; main() has already dispatched it.
+
+    const QCommandLineOption batch("batch",
+                                   "Process a directory without a window (see --batch --help).",
+                                   "output");
+    parser.addOption(batch);
+    parser.addPositionalArgument("path", "Image file or directory to open.", "[path]");
+    parser.process(application);
+
     ShowImage window;
 
+    if (parser.isSet(measureStartup))
+    {
+        window.onFirstPaint([&startup]()
+        {
+            std::cerr << "first paint after "
+                      << (startup.nsecsElapsed() / 1000000.0)
+                      << " ms\n";
+
+            QApplication::quit();
+        });
+    }
+
     QPalette palette;
     palette.setColor(QPalette::Window, Qt::black);
 
@@ -45,5 +92,28 @@ int main(int argc, char* argv[])
     window.setExtents();
     window.show();
 
-    return application.exec();
+    // Nothing from here on is needed to paint the first frame. The image
+    // format plugins are loaded in the background so that the first image
+    // opened does not wait for them.
+
+    QImageReader::setAllocationLimit(0);
+
+    if (const auto arguments = parser.positionalArguments() ; arguments.size() > 0)
+    {
+        window.open(arguments.first());
+    }
+
+    QThreadPool::globalInstance()->start(warmUpImageReaders);
+
+    const auto result = application.exec();
+
+    // Set SHOWIMAGE_SLICE_TABLE to see the kernel throughput learned
+    // during the session.
+
+    if (qEnvironmentVariableIsSet("SHOWIMAGE_SLICE_TABLE"))
+    {
+        printSliceTable(std::cerr);
+    }
+
+    return result;
 }
@@ -0,0 +1,88 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include "enlighten.h"
+#include "greyscale.h"
+#include "pipeline.h"
+#include "resample.h"
+
+// ========================================================================
+
+PipelineResult
+runPipeline(
+    const QImage& input,
+    const PipelineOptions& options)
+{
+    PipelineResult result;
+
+    auto image = (options.greyscale) ? greyscale(input) : input;
+
+    if (options.enlighten > 0.0)
+    {
+        result.hasCounts = options.countHistogram;
+        image = enlighten(image, options.enlighten, (result.hasCounts) ? &result.counts : nullptr);
+    }
+
+    if (options.size.isValid() and (options.size != image.size()))
+    {
+        image = resample(image, options.size, options.mode);
+    }
+
+    result.image = displayImage(std::move(image));
+
+    return result;
+}
+
+// ------------------------------------------------------------------------
+
+QImage
+displayImage(
+    QImage image)
+{
+    switch (image.format())
+    {
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+
+            break;
+
+        case QImage::Format_Grayscale8:
+        case QImage::Format_Grayscale16:
+        case QImage::Format_RGB888:
+        case QImage::Format_RGBX64:
+
+            image.convertTo(QImage::Format_RGB32);
+            break;
+
+        default:
+
+            image.convertTo(QImage::Format_ARGB32_Premultiplied);
+            break;
+    }
+
+    return image;
+}
@@ -0,0 +1,75 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <QImage>
+#include <QSize>
+
+#include "counts.h"
+
+// ------------------------------------------------------------------------
+
+struct PipelineOptions
+{
+    bool greyscale{false};
+    double enlighten{0.0};
+    bool countHistogram{false};
+    QSize size{};
+    Qt::TransformationMode mode{Qt::SmoothTransformation};
+};
+
+// ------------------------------------------------------------------------
+
+struct PipelineResult
+{
+    QImage image{};
+    HistogramCounts counts{};
+    bool hasCounts{false};
+};
+
+// ------------------------------------------------------------------------
+//
+// The image processing pipeline as a function of its input alone, so that
+// it can run away from the GUI thread: greyscale, enlighten (with an
+// enlighten strength from 0 to 1, 0 being off), resample to size (if it is
+// valid) and convert for display. The histogram is counted, if asked for,
+// while enlightening.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] PipelineResult runPipeline(const QImage& input, const PipelineOptions& options);
+
+// ------------------------------------------------------------------------
+//
+// QPainter draws RGB32 and ARGB32_Premultiplied images as a straight blit.
+// Anything else would be converted on every paint, so convert it once,
+// after scaling, when the image is at its display size.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] QImage displayImage(QImage image);
@@ -0,0 +1,397 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <QImage>
+#include <QRgba64>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+// ------------------------------------------------------------------------
+//
+// Pixel accessors present the scan lines of each common QImage format as
+// QRgb values, so that a kernel written once as a template gets a native
+// fast path for every format. accessor.row(j) returns a callable that
+// maps a column index to the pixel at (i, j).
+//
+// isGrey is set when red, green and blue are always equal. isPremultiplied
+// is set when the colour channels are already weighted by alpha, which is
+// also trivially true of formats without an alpha channel.
+//
+// isWide is set for the 16 bit per channel formats, whose accessors also
+// have wideRow(j), mapping a column index to a QRgba64 so that kernels can
+// keep the full precision.
+//
+// ------------------------------------------------------------------------
+
+template<bool Premultiplied>
+class PixelRgb32
+{
+public:
+
+    static constexpr bool isGrey{false};
+    static constexpr bool isPremultiplied{Premultiplied};
+    static constexpr bool isWide{false};
+
+    explicit PixelRgb32(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] const QRgb* line(int j) const noexcept { return reinterpret_cast<const QRgb*>(m_image.constScanLine(j)); }
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = reinterpret_cast<const QRgb*>(m_image.constScanLine(j));
+
+        return [line](int i) { return line[i]; };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+using PixelARGB32 = PixelRgb32<false>;
+using PixelARGB32Premultiplied = PixelRgb32<true>;
+using PixelRGB32 = PixelRgb32<true>;
+
+// ------------------------------------------------------------------------
+
+template<int Red, int Green, int Blue>
+class PixelRgb24
+{
+public:
+
+    static constexpr bool isGrey{false};
+    static constexpr bool isPremultiplied{true};
+    static constexpr bool isWide{false};
+
+    explicit PixelRgb24(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = m_image.constScanLine(j);
+
+        return [line](int i)
+        {
+            const auto* pixel = line + 3 * i;
+            return qRgb(pixel[Red], pixel[Green], pixel[Blue]);
+        };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+using PixelRGB888 = PixelRgb24<0, 1, 2>;
+using PixelBGR888 = PixelRgb24<2, 1, 0>;
+
+// ------------------------------------------------------------------------
+
+template<bool Premultiplied>
+class PixelRgba8888
+{
+public:
+
+    static constexpr bool isGrey{false};
+    static constexpr bool isPremultiplied{Premultiplied};
+    static constexpr bool isWide{false};
+
+    explicit PixelRgba8888(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = m_image.constScanLine(j);
+
+        return [line](int i)
+        {
+            const auto* pixel = line + 4 * i;
+            return qRgba(pixel[0], pixel[1], pixel[2], pixel[3]);
+        };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+// Format_RGBX8888 stores 0xFF in the alpha byte, so it reads as opaque.
+
+using PixelRGBA8888 = PixelRgba8888<false>;
+using PixelRGBA8888Premultiplied = PixelRgba8888<true>;
+using PixelRGBX8888 = PixelRgba8888<true>;
+
+// ------------------------------------------------------------------------
+
+template<bool Premultiplied>
+class PixelRgba64
+{
+public:
+
+    static constexpr bool isGrey{false};
+    static constexpr bool isPremultiplied{Premultiplied};
+    static constexpr bool isWide{true};
+
+    explicit PixelRgba64(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = reinterpret_cast<const QRgba64*>(m_image.constScanLine(j));
+
+        return [line](int i) { return line[i].toArgb32(); };
+    }
+
+    [[nodiscard]] auto wideRow(int j) const noexcept
+    {
+        const auto* line = reinterpret_cast<const QRgba64*>(m_image.constScanLine(j));
+
+        return [line](int i) { return line[i]; };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+using PixelRGBA64 = PixelRgba64<false>;
+using PixelRGBA64Premultiplied = PixelRgba64<true>;
+using PixelRGBX64 = PixelRgba64<true>;
+
+// ------------------------------------------------------------------------
+
+class PixelGrey8
+{
+public:
+
+    static constexpr bool isGrey{true};
+    static constexpr bool isPremultiplied{true};
+    static constexpr bool isWide{false};
+
+    explicit PixelGrey8(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] const uchar* line(int j) const noexcept { return m_image.constScanLine(j); }
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = m_image.constScanLine(j);
+
+        return [line](int i) { return qRgb(line[i], line[i], line[i]); };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+// ------------------------------------------------------------------------
+
+class PixelGrey16
+{
+public:
+
+    static constexpr bool isGrey{true};
+    static constexpr bool isPremultiplied{true};
+    static constexpr bool isWide{true};
+
+    explicit PixelGrey16(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = reinterpret_cast<const quint16*>(m_image.constScanLine(j));
+
+        return [line](int i)
+        {
+            const auto grey = line[i] >> 8;
+            return qRgb(grey, grey, grey);
+        };
+    }
+
+    [[nodiscard]] auto wideRow(int j) const noexcept
+    {
+        const auto* line = reinterpret_cast<const quint16*>(m_image.constScanLine(j));
+
+        return [line](int i) { return qRgba64(line[i], line[i], line[i], 0xFFFF); };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+// ------------------------------------------------------------------------
+
+class PixelIndexed8
+{
+public:
+
+    static constexpr bool isGrey{false};
+    static constexpr bool isPremultiplied{false};
+    static constexpr bool isWide{false};
+
+    explicit PixelIndexed8(const QImage& image)
+    :
+        m_image(image),
+        m_colourTable{}
+    {
+        // Pad the table out to 256 entries so that a stray index in a
+        // damaged file cannot read past the end of it.
+
+        const auto colourTable = image.colorTable();
+        const auto count = std::min<qsizetype>(colourTable.size(), m_colourTable.size());
+        std::copy(colourTable.begin(), colourTable.begin() + count, m_colourTable.begin());
+    }
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        const auto* line = m_image.constScanLine(j);
+        const auto* colourTable = m_colourTable.data();
+
+        return [line, colourTable](int i) { return colourTable[line[i]]; };
+    }
+
+private:
+
+    const QImage& m_image;
+    std::array<QRgb, 256> m_colourTable;
+};
+
+// ------------------------------------------------------------------------
+//
+// Any other format goes through QImage::pixelColor(), which is slow but
+// understands everything.
+//
+// ------------------------------------------------------------------------
+
+class PixelGeneric
+{
+public:
+
+    static constexpr bool isGrey{false};
+    static constexpr bool isPremultiplied{false};
+    static constexpr bool isWide{false};
+
+    explicit PixelGeneric(const QImage& image) noexcept : m_image(image) {}
+
+    [[nodiscard]] auto row(int j) const noexcept
+    {
+        return [&image = m_image, j](int i) { return image.pixelColor(i, j).rgba(); };
+    }
+
+private:
+
+    const QImage& m_image;
+};
+
+// ------------------------------------------------------------------------
+//
+// Call function(accessor) with the accessor matching the format of image
+// and return its result.
+//
+// ------------------------------------------------------------------------
+
+template<typename Function>
+auto
+withPixelAccessor(
+    const QImage& image,
+    Function function)
+{
+    switch (image.format())
+    {
+        case QImage::Format_ARGB32:
+
+            return function(PixelARGB32{image});
+
+        case QImage::Format_ARGB32_Premultiplied:
+
+            return function(PixelARGB32Premultiplied{image});
+
+        case QImage::Format_RGB32:
+
+            return function(PixelRGB32{image});
+
+        case QImage::Format_RGB888:
+
+            return function(PixelRGB888{image});
+
+        case QImage::Format_BGR888:
+
+            return function(PixelBGR888{image});
+
+        case QImage::Format_RGBA8888:
+
+            return function(PixelRGBA8888{image});
+
+        case QImage::Format_RGBA8888_Premultiplied:
+
+            return function(PixelRGBA8888Premultiplied{image});
+
+        case QImage::Format_RGBX8888:
+
+            return function(PixelRGBX8888{image});
+
+        case QImage::Format_RGBA64:
+
+            return function(PixelRGBA64{image});
+
+        case QImage::Format_RGBA64_Premultiplied:
+
+            return function(PixelRGBA64Premultiplied{image});
+
+        case QImage::Format_RGBX64:
+
+            return function(PixelRGBX64{image});
+
+        case QImage::Format_Grayscale8:
+
+            return function(PixelGrey8{image});
+
+        case QImage::Format_Grayscale16:
+
+            return function(PixelGrey16{image});
+
+        case QImage::Format_Indexed8:
+
+            return function(PixelIndexed8{image});
+
+        default:
+
+            return function(PixelGeneric{image});
+    }
+}
+
+// ------------------------------------------------------------------------
+
+[[nodiscard]] inline bool
+isWideImage(const QImage& image)
+{
+    return withPixelAccessor(image, [](const auto& accessor)
+    {
+        return std::decay_t<decltype(accessor)>::isWide;
+    });
+}
@@ -0,0 +1,320 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include "resample.h"
+#include "slice.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+//
+// The input pixels, starting at first, that make up one output pixel along
+// one axis, and the weight of each.
+//
+// ------------------------------------------------------------------------
+
+struct Taps
+{
+    int first{0};
+    std::vector<float> weights{};
+};
+
+using Filter = std::vector<Taps>;
+
+// ------------------------------------------------------------------------
+
+Filter
+smoothFilter(
+    int inputSize,
+    int outputSize)
+{
+    Filter filter(outputSize);
+    const auto scale = static_cast<double>(inputSize) / outputSize;
+
+    for (auto i = 0 ; i < outputSize ; ++i)
+    {
+        auto& taps = filter[i];
+
+        if (scale > 1.0)
+        {
+            // Shrinking: average the input pixels the output pixel covers,
+            // weighted by how much of each it covers.
+
+            const auto start = i * scale;
+            const auto end = std::min(start + scale, static_cast<double>(inputSize));
+            const auto last = std::min(static_cast<int>(std::ceil(end)) - 1, inputSize - 1);
+
+            taps.first = static_cast<int>(start);
+
+            for (auto k = taps.first ; k <= last ; ++k)
+            {
+                const auto overlap = std::min(end, k + 1.0) - std::max(start, static_cast<double>(k));
+                taps.weights.push_back(static_cast<float>(overlap / scale));
+            }
+        }
+        else if (inputSize == 1)
+        {
+            taps.weights.push_back(1.0F);
+        }
+        else
+        {
+            // Enlarging: interpolate between the two nearest input pixels.
+
+            const auto centre = std::clamp(((i + 0.5) * scale) - 0.5, 0.0, inputSize - 1.0);
+            taps.first = std::min(static_cast<int>(centre), inputSize - 2);
+
+            const auto fraction = static_cast<float>(centre - taps.first);
+            taps.weights.push_back(1.0F - fraction);
+            taps.weights.push_back(fraction);
+        }
+    }
+
+    return filter;
+}
+
+// ------------------------------------------------------------------------
+
+std::vector<int>
+nearestFilter(
+    int inputSize,
+    int outputSize)
+{
+    std::vector<int> filter(outputSize);
+    const auto scale = static_cast<double>(inputSize) / outputSize;
+
+    for (auto i = 0 ; i < outputSize ; ++i)
+    {
+        filter[i] = std::min(static_cast<int>((i + 0.5) * scale), inputSize - 1);
+    }
+
+    return filter;
+}
+
+// ------------------------------------------------------------------------
+//
+// Each output row is made by summing the input rows it draws on into a
+// row of floats, and then resampling that row horizontally. Every channel
+// is treated alike, which is right for premultiplied and opaque pixels.
+//
+// ------------------------------------------------------------------------
+
+template<typename Channel, int Channels>
+void
+smoothRows(
+    int jStart,
+    int jEnd,
+    const QImage& input,
+    const ScanLines& output,
+    const Filter& columns,
+    const Filter& rows)
+{
+    static constexpr float ChannelMaximum{static_cast<float>(std::numeric_limits<Channel>::max())};
+
+    const auto inputValues = input.width() * Channels;
+    const auto outputWidth = static_cast<int>(columns.size());
+    std::vector<float> sums(inputValues);
+
+    for (auto j = jStart ; j < jEnd ; ++j)
+    {
+        const auto& row = rows[j];
+
+        std::fill(sums.begin(), sums.end(), 0.0F);
+
+        for (auto k = 0 ; k < static_cast<int>(row.weights.size()) ; ++k)
+        {
+            const auto* inputRow = reinterpret_cast<const Channel*>(input.constScanLine(row.first + k));
+            const auto weight = row.weights[k];
+
+            for (auto n = 0 ; n < inputValues ; ++n)
+            {
+                sums[n] += weight * inputRow[n];
+            }
+        }
+
+        auto* outputRow = reinterpret_cast<Channel*>(output[j]);
+
+        for (auto i = 0 ; i < outputWidth ; ++i)
+        {
+            const auto& column = columns[i];
+            const auto* sum = sums.data() + (column.first * Channels);
+            std::array<float, Channels> pixel{};
+
+            for (const auto weight : column.weights)
+            {
+                for (auto c = 0 ; c < Channels ; ++c)
+                {
+                    pixel[c] += weight * sum[c];
+                }
+
+                sum += Channels;
+            }
+
+            for (auto c = 0 ; c < Channels ; ++c)
+            {
+                *(outputRow++) = static_cast<Channel>(std::clamp(pixel[c] + 0.5F, 0.0F, ChannelMaximum));
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+template<typename Pixel>
+void
+nearestRows(
+    int jStart,
+    int jEnd,
+    const QImage& input,
+    const ScanLines& output,
+    const std::vector<int>& columns,
+    const std::vector<int>& rows)
+{
+    const auto outputWidth = static_cast<int>(columns.size());
+
+    for (auto j = jStart ; j < jEnd ; ++j)
+    {
+        const auto* inputRow = reinterpret_cast<const Pixel*>(input.constScanLine(rows[j]));
+        auto* outputRow = reinterpret_cast<Pixel*>(output[j]);
+
+        for (auto i = 0 ; i < outputWidth ; ++i)
+        {
+            outputRow[i] = inputRow[columns[i]];
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+template<typename Channel, int Channels>
+QImage
+smooth(
+    const QImage& input,
+    const QSize& size)
+{
+    QImage output{size, input.format()};
+
+    const auto columns = smoothFilter(input.width(), size.width());
+    const auto rows = smoothFilter(input.height(), size.height());
+
+    const ScanLines outputLines{output};
+    concurrentRows("resample smooth", output, [&](int jStart, int jEnd)
+    {
+        smoothRows<Channel, Channels>(jStart, jEnd, input, outputLines, columns, rows);
+    });
+
+    return output;
+}
+
+// ------------------------------------------------------------------------
+
+template<typename Pixel>
+QImage
+nearest(
+    const QImage& input,
+    const QSize& size)
+{
+    QImage output{size, input.format()};
+
+    const auto columns = nearestFilter(input.width(), size.width());
+    const auto rows = nearestFilter(input.height(), size.height());
+
+    const ScanLines outputLines{output};
+    concurrentRows("resample fast", output, [&](int jStart, int jEnd)
+    {
+        nearestRows<Pixel>(jStart, jEnd, input, outputLines, columns, rows);
+    });
+
+    return output;
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+QImage
+resample(
+    const QImage& input,
+    const QSize& size,
+    Qt::TransformationMode mode)
+{
+    if (input.isNull() or size.isEmpty())
+    {
+        return QImage{};
+    }
+
+    if (size == input.size())
+    {
+        return input;
+    }
+
+    const auto isSmooth = (mode == Qt::SmoothTransformation);
+
+    switch (input.format())
+    {
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+
+            return (isSmooth)
+                 ? smooth<std::uint8_t, 4>(input, size)
+                 : nearest<std::uint32_t>(input, size);
+
+        case QImage::Format_RGBX64:
+        case QImage::Format_RGBA64_Premultiplied:
+
+            return (isSmooth)
+                 ? smooth<std::uint16_t, 4>(input, size)
+                 : nearest<std::uint64_t>(input, size);
+
+        case QImage::Format_Grayscale8:
+
+            return (isSmooth)
+                 ? smooth<std::uint8_t, 1>(input, size)
+                 : nearest<std::uint8_t>(input, size);
+
+        case QImage::Format_Grayscale16:
+
+            return (isSmooth)
+                 ? smooth<std::uint16_t, 1>(input, size)
+                 : nearest<std::uint16_t>(input, size);
+
+        default:
+
+            return input.scaled(size, Qt::IgnoreAspectRatio, mode);
+    }
+}
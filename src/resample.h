@@ -0,0 +1,49 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <QImage>
+#include <QSize>
+
+// ------------------------------------------------------------------------
+//
+// Resample an image to size, in row bands spread across the thread pool.
+// Qt::SmoothTransformation averages the area each output pixel covers when
+// shrinking, and interpolates bilinearly when enlarging, in the manner of
+// QImage::scaled(). Qt::FastTransformation picks the nearest pixel.
+//
+// The working formats (see workingImage()) are resampled natively; any
+// other format is passed to QImage::scaled().
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] QImage
+resample(
+    const QImage& input,
+    const QSize& size,
+    Qt::TransformationMode mode);
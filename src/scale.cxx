@@ -25,8 +25,32 @@
 //
 //-------------------------------------------------------------------------
 
+#include "resample.h"
 #include "scale.h"
 
+// ------------------------------------------------------------------------
+//
+// The size scale() would display the last image at, for the current zoom
+// and screen size.
+//
+// ------------------------------------------------------------------------
+
+QSize
+Scale::displaySize() const noexcept
+{
+    if (notScaled() or scaleActualSize())
+    {
+        return m_imageSize;
+    }
+
+    if (scaleZoomed())
+    {
+        return m_imageSize * m_zoom;
+    }
+
+    return m_imageSize.scaled(m_screenSize, Qt::KeepAspectRatio);
+}
+
 //-------------------------------------------------------------------------
 
 bool
@@ -62,30 +86,38 @@ Scale::oversize() const noexcept
 // ------------------------------------------------------------------------
 
 QImage
-Scale::scale(const QImage& image)
+Scale::scale(
+    const QImage& image,
+    Qt::TransformationMode mode)
 {
     QImage result;
 
     m_imageSize = image.size();
+    m_paintZoom = 1;
 
     if (notScaled() or scaleActualSize())
     {
         result = image;
         m_percent = 100;
     }
+    else if (scaleZoomed() and (mode == Qt::FastTransformation))
+    {
+        // Replicating pixels is left to paint time, where only the visible
+        // part of the image need be drawn (see paintZoom()). This is also
+        // how a fast preview of a smooth zoom is shown.
+
+        result = image;
+        m_paintZoom = m_zoom;
+        m_percent = m_zoom * 100;
+    }
     else if (scaleZoomed())
     {
-        result = image.scaled(image.width() * m_zoom,
-                              image.height() * m_zoom,
-                              Qt::KeepAspectRatio,
-                              transformationMode());
+        result = resample(image, displaySize(), mode);
         m_percent = m_zoom * 100;
     }
     else
     {
-        result = image.scaled(m_screenSize,
-                              Qt::KeepAspectRatio,
-                              transformationMode());
+        result = resample(image, displaySize(), mode);
 
         const double percent = (image.width() > 0)
                                 ? std::round((100.0 * result.width()) / image.width())
@@ -93,7 +125,7 @@ Scale::scale(const QImage& image)
         m_percent = static_cast<int>(percent);
     }
 
-    m_processedSize = result.size();
+    m_processedSize = result.size() * m_paintZoom;
 
     return result;
 }
@@ -39,20 +39,27 @@ public:
     [[nodiscard]] const char* fitToScreenLabel() const noexcept { return (m_fitToScreen) ? " [ FTS ]" : " [ FOS ]"; }
     [[nodiscard]] bool notScaled() const noexcept { return scaleOversized() and not oversize() and not m_fitToScreen; }
     [[nodiscard]] bool originalSize() const noexcept { return m_percent == 100; }
+    [[nodiscard]] int paintZoom() const noexcept { return m_paintZoom; }
     [[nodiscard]] int percent() const noexcept { return m_percent; }
+    [[nodiscard]] QSize processedSize() const noexcept { return m_processedSize; }
     [[nodiscard]] bool scaleActualSize() const noexcept { return m_zoom == 1; }
     [[nodiscard]] bool scaleOversized() const noexcept { return m_zoom == SCALE_OVERSIZED; }
     [[nodiscard]] bool scaleZoomed() const noexcept { return m_zoom > 1; }
+    [[nodiscard]] bool smoothScale() const noexcept { return m_smoothScale; }
     void toggleFitToScreen() noexcept { m_fitToScreen = !m_fitToScreen; }
     void toggleSmoothScale() noexcept { m_smoothScale = !m_smoothScale; }
+    [[nodiscard]] Qt::TransformationMode transformationMode() const noexcept;
     [[nodiscard]] const char* transformationLabel() const noexcept { return (m_smoothScale) ? " [ smooth ]" : " [ fast ]"; }
     [[nodiscard]] int zoomedHeight() const { return m_imageSize.height() * zoomValue(); }
     [[nodiscard]] int zoomedWidth() const { return m_imageSize.width() * zoomValue(); }
     [[nodiscard]] int zoomValue() const noexcept { return (m_zoom == 0) ? 1 : m_zoom; }
 
+    [[nodiscard]] QSize displaySize() const noexcept;
     [[nodiscard]] bool fitsWithinScreen() const noexcept;
     [[nodiscard]] bool oversize() const noexcept;
-    [[nodiscard]] QImage scale(const QImage& image);
+    [[nodiscard]] QImage scale(const QImage& image) { return scale(image, transformationMode()); }
+    [[nodiscard]] QImage scale(const QImage& image, Qt::TransformationMode mode);
+    void resampled(const QSize& size) noexcept { m_paintZoom = 1; m_processedSize = size; }
     void screenResize(const QSize& size) noexcept { m_screenSize = size; }
     [[nodiscard]] bool zoomIn() noexcept;
     [[nodiscard]] bool zoomOut() noexcept;
@@ -65,10 +72,9 @@ private:
         SCALE_MAXIMUM = 5
     };
 
-    [[nodiscard]] Qt::TransformationMode transformationMode() const noexcept;
-
     bool m_fitToScreen{true};
     QSize m_imageSize{};
+    int m_paintZoom{1};
     int m_percent{0};
     QSize m_processedSize{};
     QSize m_screenSize{};
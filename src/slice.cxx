@@ -25,40 +25,91 @@
 //
 //-------------------------------------------------------------------------
 
-#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
 
 #include "slice.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <utility>
+
 // ========================================================================
 namespace
 {
 
 // ------------------------------------------------------------------------
+//
+// A slice should carry at least MinSliceNanoseconds of work, so that the
+// cost of handing it to a thread is small by comparison. Until a kernel
+// has been measured its cost is assumed to be DefaultNanosecondsPerPixel.
+// No more than SlicesPerThread slices are made per thread; the extra
+// slices even out the load when some slices finish early.
+//
+// ------------------------------------------------------------------------
+
+static constexpr double MinSliceNanoseconds{100'000.0};
+static constexpr double DefaultNanosecondsPerPixel{2.0};
+static constexpr int SlicesPerThread{4};
+
+// Weight given to each new measurement in the running average.
+
+static constexpr double MeasurementWeight{0.25};
+
+// ------------------------------------------------------------------------
+
+struct Throughput
+{
+    double nanosecondsPerPixel{DefaultNanosecondsPerPixel};
+    long samples{0};
+};
+
+using ThroughputKey = std::pair<std::string, QImage::Format>;
+
+QMutex throughputMutex;
+std::map<ThroughputKey, Throughput> throughputTable;
+
+// ------------------------------------------------------------------------
+
+double
+nanosecondsPerPixel(
+    const char* kernel,
+    QImage::Format format)
+{
+    QMutexLocker locker(&throughputMutex);
 
-static constexpr int MinSliceSize{100};
+    const auto iter = throughputTable.find({kernel, format});
+
+    return (iter == throughputTable.end())
+           ? DefaultNanosecondsPerPixel
+           : iter->second.nanosecondsPerPixel;
+}
 
 // ------------------------------------------------------------------------
 
 std::optional<int>
 concurrentSlice(
+    const char* kernel,
+    const QImage& image,
     int dimensionSize)
 {
-    const auto cores = QThread::idealThreadCount();
+    const auto threads = QThreadPool::globalInstance()->maxThreadCount();
+    const auto pixels = static_cast<double>(image.width()) * image.height();
+    const auto work = pixels * nanosecondsPerPixel(kernel, image.format());
 
-    if ((cores == 1) or (dimensionSize < 2 * MinSliceSize))
-    {
-        return {};
-    }
+    const auto slices = std::min({static_cast<double>(threads * SlicesPerThread),
+                                  static_cast<double>(dimensionSize),
+                                  work / MinSliceNanoseconds});
 
-    for (auto threads = 2 ; threads < cores - 1 ; ++threads)
+    if ((threads == 1) or (slices < 2.0))
     {
-        if (dimensionSize / (threads + 1) < MinSliceSize)
-        {
-            return threads;
-        }
+        return {};
     }
 
-    return cores;
+    return static_cast<int>(slices);
 }
 
 // ------------------------------------------------------------------------
@@ -69,16 +120,70 @@ concurrentSlice(
 
 std::optional<int>
 concurrentColumnSlice(
+    const char* kernel,
     const QImage& image)
 {
-    return concurrentSlice(image.width());
+    return concurrentSlice(kernel, image, image.width());
 }
 
 //-------------------------------------------------------------------------
 
 std::optional<int>
 concurrentRowSlice(
+    const char* kernel,
     const QImage& image)
 {
-    return concurrentSlice(image.height());
+    return concurrentSlice(kernel, image, image.height());
+}
+
+//-------------------------------------------------------------------------
+
+void
+recordSliceTime(
+    const char* kernel,
+    const QImage& image,
+    std::int64_t nanoseconds)
+{
+    const auto pixels = static_cast<double>(image.width()) * image.height();
+
+    if (pixels == 0.0)
+    {
+        return;
+    }
+
+    const auto measured = nanoseconds / pixels;
+
+    QMutexLocker locker(&throughputMutex);
+
+    auto& throughput = throughputTable[{kernel, image.format()}];
+
+    throughput.nanosecondsPerPixel = (throughput.samples == 0)
+                                   ? measured
+                                   : (throughput.nanosecondsPerPixel * (1.0 - MeasurementWeight)) +
+                                     (measured * MeasurementWeight);
+    ++throughput.samples;
+}
+
+//-------------------------------------------------------------------------
+
+void
+printSliceTable(
+    std::ostream& stream)
+{
+    QMutexLocker locker(&throughputMutex);
+
+    stream << std::left
+           << std::setw(24) << "kernel"
+           << std::setw(8) << "format"
+           << std::setw(10) << "samples"
+           << "ns/pixel\n";
+
+    for (const auto& [key, throughput] : throughputTable)
+    {
+        stream << std::setw(24) << key.first
+               << std::setw(8) << key.second
+               << std::setw(10) << throughput.samples
+               << std::fixed << std::setprecision(3)
+               << throughput.nanosecondsPerPixel << '\n';
+    }
 }
@@ -27,7 +27,15 @@
 
 #pragma once
 
-#include <QChar>
+#include <QImage>
 
-extern uchar splash[];
+// ------------------------------------------------------------------------
+//
+// The splash is kept as a compressed resource (assets/splash.png) and is
+// decoded on first use, converted to a format that paints without
+// conversion.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] QImage splashImage();
 
@@ -0,0 +1,296 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#include "statistics.h"
+
+#include <cstring>
+#include <type_traits>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+
+static constexpr char StoreMagic[]{"showimage statistics 1\n"};
+static constexpr int StoreMagicSize{sizeof(StoreMagic) - 1};
+static constexpr int StoreSize{StoreMagicSize + sizeof(HistogramCounts)};
+
+static_assert(std::is_trivially_copyable_v<HistogramCounts>);
+
+// ------------------------------------------------------------------------
+
+void
+writeStore(
+    const QString& path,
+    const HistogramCounts& counts)
+{
+    QSaveFile file{path};
+
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(StoreMagic, StoreMagicSize);
+        file.write(reinterpret_cast<const char*>(&counts), sizeof(counts));
+        file.commit();
+    }
+}
+
+// ------------------------------------------------------------------------
+
+std::optional<HistogramCounts>
+readStore(const QString& path)
+{
+    QFile file{path};
+
+    if (not file.open(QIODevice::ReadOnly))
+    {
+        return std::nullopt;
+    }
+
+    const auto data = file.readAll();
+
+    if ((data.size() != StoreSize) or
+        (std::memcmp(data.constData(), StoreMagic, StoreMagicSize) != 0))
+    {
+        return std::nullopt;
+    }
+
+    HistogramCounts counts;
+    std::memcpy(&counts, data.constData() + StoreMagicSize, sizeof(counts));
+
+    return counts;
+}
+
+// ------------------------------------------------------------------------
+
+void
+pruneStore(
+    const QString& store,
+    int capacity)
+{
+    // Newest first, so everything past capacity is the oldest. Nothing
+    // else writes to the store while this runs (see insert()).
+
+    const auto files = QDir{store}.entryInfoList(QDir::Files, QDir::Time);
+    const auto count = static_cast<qsizetype>(files.size());
+
+    for (qsizetype i = capacity ; i < count ; ++i)
+    {
+        QFile::remove(files[i].absoluteFilePath());
+    }
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+ImageStatistics
+imageStatistics(
+    const HistogramCounts& counts,
+    bool intensity)
+{
+    ImageStatistics statistics;
+
+    auto first = -1;
+    auto last = -1;
+    double total{0.0};
+    double sum{0.0};
+
+    for (auto i = 0 ; i < static_cast<int>(counts.intensity.size()) ; ++i)
+    {
+        const auto& rgb = counts.rgb[i];
+        const auto count = (intensity)
+                         ? counts.intensity[i]
+                         : rgb.r + rgb.g + rgb.b;
+
+        if (count > 0)
+        {
+            first = (first == -1) ? i : first;
+            last = i;
+            total += count;
+            sum += static_cast<double>(count) * i;
+        }
+    }
+
+    if (total > 0.0)
+    {
+        statistics.minimum = first;
+        statistics.maximum = last;
+        statistics.mean = sum / total;
+    }
+
+    return statistics;
+}
+
+// ------------------------------------------------------------------------
+
+QString
+statisticsKey(
+    const QString& path,
+    int frame,
+    bool greyscale,
+    int enlighten)
+{
+    const QFileInfo file{path};
+
+    return file.absoluteFilePath() +
+           "|" + QString::number(file.lastModified().toMSecsSinceEpoch()) +
+           "|" + QString::number(file.size()) +
+           "|" + QString::number(frame) +
+           "|" + QString::number(greyscale ? 1 : 0) +
+           "|" + QString::number(enlighten);
+}
+
+// ========================================================================
+
+StatisticsCache::StatisticsCache(
+    int capacity)
+:
+    m_memory(capacity)
+{
+    if (qEnvironmentVariableIsSet("SHOWIMAGE_STATISTICS_CACHE"))
+    {
+        const auto cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+        if (not cache.isEmpty() and QDir{}.mkpath(cache + "/statistics"))
+        {
+            m_store = cache + "/statistics";
+        }
+    }
+
+    // One writer, so that files are written, and pruned, one at a time.
+
+    m_storeWriter.setMaxThreadCount(1);
+
+    if (not m_store.isEmpty())
+    {
+        m_storeWriter.start([store = m_store]()
+        {
+            pruneStore(store, STORE_CAPACITY);
+        });
+    }
+}
+
+// ------------------------------------------------------------------------
+
+std::optional<HistogramCounts>
+StatisticsCache::find(
+    const QString& key)
+{
+    if (const auto* counts = m_memory.object(key))
+    {
+        return *counts;
+    }
+
+    return std::nullopt;
+}
+
+// ------------------------------------------------------------------------
+
+void
+StatisticsCache::insert(
+    const QString& key,
+    const HistogramCounts& counts)
+{
+    m_memory.insert(key, new HistogramCounts{counts});
+
+    if (m_store.isEmpty())
+    {
+        return;
+    }
+
+    // Writing is left to m_storeWriter, off the GUI thread. An animation
+    // stores a file per frame, so the store is pruned every so often.
+
+    const auto prune = ((++m_storeWrites % STORE_PRUNE_INTERVAL) == 0);
+
+    m_storeWriter.start([store = m_store, path = storePath(key), counts, prune]()
+    {
+        writeStore(path, counts);
+
+        if (prune)
+        {
+            pruneStore(store, STORE_CAPACITY);
+        }
+    });
+}
+
+// ------------------------------------------------------------------------
+//
+// Reads the stored counts on m_storeWriter, after any writes already
+// queued there. The caller hands them back to restore() on its own
+// thread, so that m_memory is only ever touched from one.
+//
+// ------------------------------------------------------------------------
+
+QFuture<std::optional<HistogramCounts>>
+StatisticsCache::load(
+    const QString& key)
+{
+    // Without a store the empty path fails to open.
+
+    const auto path = (m_store.isEmpty()) ? QString{} : storePath(key);
+
+    return QtConcurrent::run(&m_storeWriter, [path]()
+    {
+        return readStore(path);
+    });
+}
+
+// ------------------------------------------------------------------------
+
+void
+StatisticsCache::restore(
+    const QString& key,
+    const HistogramCounts& counts)
+{
+    m_memory.insert(key, new HistogramCounts{counts});
+}
+
+// ------------------------------------------------------------------------
+
+QString
+StatisticsCache::storePath(
+    const QString& key) const
+{
+    const auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+
+    return m_store + "/" + QString::fromUtf8(hash.toHex());
+}
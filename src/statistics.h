@@ -0,0 +1,109 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2025 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <QCache>
+#include <QFuture>
+#include <QString>
+#include <QThreadPool>
+
+#include "counts.h"
+
+#include <optional>
+
+// ------------------------------------------------------------------------
+
+struct ImageStatistics
+{
+    int minimum{0};
+    int maximum{0};
+    double mean{0.0};
+
+    bool operator==(const ImageStatistics&) const = default;
+};
+
+// ------------------------------------------------------------------------
+//
+// Minimum, maximum and mean value, taken from the intensity counts, or
+// from the red, green and blue counts together.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] ImageStatistics imageStatistics(const HistogramCounts& counts, bool intensity);
+
+// ------------------------------------------------------------------------
+//
+// Identifies the processed image statistics are taken from: the file, by
+// path, modification time and size, the frame and the processing applied
+// to it.
+//
+// ------------------------------------------------------------------------
+
+[[nodiscard]] QString statisticsKey(const QString& path, int frame, bool greyscale, int enlighten);
+
+// ------------------------------------------------------------------------
+//
+// Exact histogram counts of recently viewed images, held in memory and,
+// when SHOWIMAGE_STATISTICS_CACHE is set, in the user's cache directory
+// so that they survive between sessions. find() only looks in memory;
+// files are read by load() and written by insert() on a thread of their
+// own, and the oldest are removed once there are more than STORE_CAPACITY
+// of them.
+//
+// ------------------------------------------------------------------------
+
+class StatisticsCache
+{
+public:
+
+    static const int DEFAULT_CAPACITY{256};
+    static const int STORE_CAPACITY{4096};
+    static const int STORE_PRUNE_INTERVAL{64};
+
+    explicit StatisticsCache(int capacity = DEFAULT_CAPACITY);
+
+    StatisticsCache(const StatisticsCache&) = delete;
+    StatisticsCache(StatisticsCache &&) = delete;
+    StatisticsCache& operator=(const StatisticsCache&) = delete;
+    StatisticsCache& operator=(StatisticsCache &&) = delete;
+
+    [[nodiscard]] std::optional<HistogramCounts> find(const QString& key);
+    [[nodiscard]] bool hasStore() const noexcept { return not m_store.isEmpty(); }
+    void insert(const QString& key, const HistogramCounts& counts);
+    [[nodiscard]] QFuture<std::optional<HistogramCounts>> load(const QString& key);
+    void restore(const QString& key, const HistogramCounts& counts);
+
+private:
+
+    [[nodiscard]] QString storePath(const QString& key) const;
+
+    QCache<QString, HistogramCounts> m_memory;
+    QString m_store{};
+    int m_storeWrites{0};
+    QThreadPool m_storeWriter{};
+};
@@ -0,0 +1,294 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2024 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+// ------------------------------------------------------------------------
+//
+// A stress test for the concurrent kernels, meant to be run under
+// ThreadSanitizer (configure with -DSHOWIMAGE_THREAD_SANITIZER=ON). Each
+// kernel is run once on a single thread for a reference, then repeatedly
+// from several threads at once, with its row slices spread across the
+// global thread pool, and every result is compared with the reference.
+//
+//     showimage_stress [iterations]
+//
+// Returns non zero if any result differs.
+//
+// ------------------------------------------------------------------------
+
+#include <QImage>
+#include <QThread>
+#include <QThreadPool>
+
+#include "enlighten.h"
+#include "histogram.h"
+#include "slice.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ========================================================================
+
+namespace
+{
+
+// ------------------------------------------------------------------------
+
+static constexpr int ImageWidth{1024};
+static constexpr int ImageHeight{768};
+static constexpr int ForcedSlices{16};
+static constexpr int StressThreads{4};
+static constexpr int DefaultIterations{50};
+
+// ------------------------------------------------------------------------
+
+QImage
+stressImage(QImage::Format format)
+{
+    QImage image{ImageWidth, ImageHeight, QImage::Format_ARGB32};
+
+    for (auto j = 0 ; j < ImageHeight ; ++j)
+    {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(j));
+
+        for (auto i = 0 ; i < ImageWidth ; ++i)
+        {
+            const auto noise = static_cast<int>(((i * 7919u) ^ (j * 104729u)) % 32u);
+            const auto alpha = ((i < 64) or (j < 64)) ? 96 : 255;
+
+            line[i] = qRgba((i * 223 / ImageWidth) + noise,
+                            (j * 223 / ImageHeight) + noise,
+                            ((i + j) * 223 / (ImageWidth + ImageHeight)) + noise,
+                            alpha);
+        }
+    }
+
+    return image.convertToFormat(format);
+}
+
+// ------------------------------------------------------------------------
+//
+// concurrentFor() and concurrentReduce() with a fixed number of slices,
+// so that they run concurrently whatever the learned kernel costs.
+//
+// ------------------------------------------------------------------------
+
+QImage
+invertRows(const QImage& input)
+{
+    auto output = input.copy();
+    const ScanLines lines{output};
+    const auto bytes = static_cast<int>(output.bytesPerLine());
+
+    concurrentFor("stress invert", input, input.height(), ForcedSlices, [&lines, bytes](int jStart, int jEnd)
+    {
+        for (auto j = jStart ; j < jEnd ; ++j)
+        {
+            std::transform(lines[j], lines[j] + bytes, lines[j], [](uchar value)
+            {
+                return static_cast<uchar>(~value);
+            });
+        }
+    });
+
+    return output;
+}
+
+qint64
+sumRows(const QImage& input)
+{
+    const auto bytes = static_cast<int>(input.bytesPerLine());
+
+    return concurrentReduce<qint64>(
+        "stress sum",
+        input,
+        input.height(),
+        ForcedSlices,
+        [&input, bytes](int jStart, int jEnd)
+        {
+            qint64 sum{0};
+
+            for (auto j = jStart ; j < jEnd ; ++j)
+            {
+                const auto* line = input.constScanLine(j);
+                sum += std::accumulate(line, line + bytes, qint64{0});
+            }
+
+            return sum;
+        },
+        [](qint64& target, qint64 source)
+        {
+            target += source;
+        });
+}
+
+// ------------------------------------------------------------------------
+
+struct Results
+{
+    QImage inverted{};
+    qint64 sum{0};
+    QImage maximum{};
+    QImage blurred{};
+    QImage enlightened{};
+    QImage enlightenedCounted{};
+    HistogramCounts counts{};
+    RGBCountArray rgb{};
+    IntensityCountArray intensity{};
+};
+
+Results
+run(const QImage& input)
+{
+    Results results;
+
+    results.inverted = invertRows(input);
+    results.sum = sumRows(input);
+    results.maximum = maximum(input);
+    results.blurred = blur(results.maximum, 12);
+    results.enlightened = enlighten(input, 0.5);
+    results.enlightenedCounted = enlighten(input, 0.5, &results.counts);
+    results.rgb = histogramRGBCounts(input);
+    results.intensity = histogramIntensityCounts(input);
+
+    return results;
+}
+
+// ------------------------------------------------------------------------
+
+std::vector<std::string>
+differences(
+    const Results& results,
+    const Results& reference)
+{
+    std::vector<std::string> names;
+
+    auto check = [&names](bool same, const char* name)
+    {
+        if (not same)
+        {
+            names.push_back(name);
+        }
+    };
+
+    check(results.inverted == reference.inverted, "concurrentFor");
+    check(results.sum == reference.sum, "concurrentReduce");
+    check(results.maximum == reference.maximum, "maximum");
+    check(results.blurred == reference.blurred, "blur");
+    check(results.enlightened == reference.enlightened, "enlighten");
+    check(results.enlightenedCounted == reference.enlightenedCounted, "enlighten counted");
+    check(results.counts == reference.counts, "enlighten counts");
+    check(results.rgb == reference.rgb, "histogramRGBCounts");
+    check(results.intensity == reference.intensity, "histogramIntensityCounts");
+
+    return names;
+}
+
+// ------------------------------------------------------------------------
+
+}
+
+// ========================================================================
+
+int
+main(
+    int argc,
+    char* argv[])
+{
+    const auto iterations = (argc > 1) ? std::max(1, std::atoi(argv[1])) : DefaultIterations;
+
+    const std::vector<QImage::Format> formats
+    {
+        QImage::Format_RGB32,
+        QImage::Format_ARGB32_Premultiplied,
+        QImage::Format_Grayscale8,
+        QImage::Format_RGBX64,
+        QImage::Format_RGBA64_Premultiplied
+    };
+
+    std::vector<QImage> inputs;
+    std::vector<Results> references;
+
+    // With one thread in the pool every kernel runs in a single slice,
+    // apart from the forced slices of invertRows() and sumRows().
+
+    auto* pool = QThreadPool::globalInstance();
+    pool->setMaxThreadCount(1);
+
+    for (const auto format : formats)
+    {
+        inputs.push_back(stressImage(format));
+        references.push_back(run(inputs.back()));
+    }
+
+    pool->setMaxThreadCount(std::max(QThread::idealThreadCount(), StressThreads));
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+
+    for (auto t = 0 ; t < StressThreads ; ++t)
+    {
+        threads.emplace_back([&]()
+        {
+            for (auto iteration = 0 ; iteration < iterations ; ++iteration)
+            {
+                for (std::size_t k = 0 ; k < inputs.size() ; ++k)
+                {
+                    for (const auto& name : differences(run(inputs[k]), references[k]))
+                    {
+                        ++failures;
+                        std::cerr << "format " << formats[k] << ": " << name << " differs\n";
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto failed = failures.load();
+
+    std::cout << ((failed == 0) ? "passed" : "FAILED")
+              << " ("
+              << failed
+              << " differences in "
+              << iterations * StressThreads
+              << " runs of "
+              << inputs.size()
+              << " formats)\n";
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+